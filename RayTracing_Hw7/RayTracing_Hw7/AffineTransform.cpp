@@ -0,0 +1,116 @@
+#include "AffineTransform.h"
+#include <algorithm>
+#include <iostream>
+
+AffineTransform::AffineTransform()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			elements[i][j] = (i == j) ? 1.0f : 0.0f;
+			inverseElements[i][j] = elements[i][j];
+		}
+	}
+}
+
+AffineTransform::AffineTransform(const Matrix4f& matrix)
+{
+	// The last row of the matrix is dropped, transformations of the scene are affine.
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			elements[i][j] = matrix[i][j];
+		}
+	}
+
+	computeInverse();
+}
+
+AffineTransform::AffineTransform(const Matrix4f& matrix, const Matrix4f& inverseMatrix)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			elements[i][j] = matrix[i][j];
+			inverseElements[i][j] = inverseMatrix[i][j];
+		}
+	}
+}
+
+AffineTransform AffineTransform::operator*(const AffineTransform& rhs) const
+{
+	// (A * B)^-1 = B^-1 * A^-1, the inverse of the product needs no inversion.
+	AffineTransform result;
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			result.elements[i][j] = (j == 3) ? elements[i][3] : 0.0f;
+			result.inverseElements[i][j] = (j == 3) ? rhs.inverseElements[i][3] : 0.0f;
+			for (int k = 0; k < 3; k++)
+			{
+				result.elements[i][j] += elements[i][k] * rhs.elements[k][j];
+				result.inverseElements[i][j] += rhs.inverseElements[i][k] * inverseElements[k][j];
+			}
+		}
+	}
+
+	return result;
+}
+
+AffineTransform AffineTransform::inverse() const
+{
+	AffineTransform result;
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			result.elements[i][j] = inverseElements[i][j];
+			result.inverseElements[i][j] = elements[i][j];
+		}
+	}
+
+	return result;
+}
+
+void AffineTransform::computeInverse()
+{
+	// Inverse of the 3x3 part from its cofactors, the translation becomes -A^-1 * t.
+	float cofactors[3][3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			int i1 = (i + 1) % 3;
+			int i2 = (i + 2) % 3;
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+			cofactors[i][j] = elements[i1][j1] * elements[i2][j2] - elements[i1][j2] * elements[i2][j1];
+		}
+	}
+
+	float determinant = elements[0][0] * cofactors[0][0] + elements[0][1] * cofactors[0][1] + elements[0][2] * cofactors[0][2];
+	if (determinant == 0.0f)
+	{
+		std::cout << "Transformation is not invertible" << std::endl;
+		determinant = 1.0f;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			inverseElements[i][j] = cofactors[j][i] / determinant;
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		inverseElements[i][3] = -(inverseElements[i][0] * elements[0][3] + inverseElements[i][1] * elements[1][3] + inverseElements[i][2] * elements[2][3]);
+	}
+}
\ No newline at end of file
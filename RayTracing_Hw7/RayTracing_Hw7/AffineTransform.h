@@ -0,0 +1,66 @@
+#ifndef AFFINETRANSFORM_H_
+#define AFFINETRANSFORM_H_
+
+#include "Vec3f.h"
+#include "Matrix4f.h"
+
+// Affine transformation of an object, only the upper 3x4 part of the matrix is stored since the last row is (0, 0, 0, 1).
+// The inverse is computed once, its transposed 3x3 part is the normal matrix.
+class AffineTransform
+{
+public:
+	AffineTransform();	// identity
+	AffineTransform(const Matrix4f& matrix);
+	AffineTransform(const Matrix4f& matrix, const Matrix4f& inverseMatrix);	// inverse is known, no inversion is done
+	AffineTransform operator*(const AffineTransform& rhs) const;
+	AffineTransform inverse() const;
+	Vec3f multiplyWithPoint(const Vec3f& point) const;
+	Vec3f multiplyWithVector(const Vec3f& vector) const;
+	Vec3f multiplyWithNormal(const Vec3f& normal) const;	// result is not normalized
+	Vec3f inverseMultiplyWithPoint(const Vec3f& point) const;
+	Vec3f inverseMultiplyWithVector(const Vec3f& vector) const;
+
+private:
+	float elements[3][4];
+	float inverseElements[3][4];
+
+	void computeInverse();
+};
+
+inline Vec3f AffineTransform::multiplyWithPoint(const Vec3f& point) const
+{
+	return Vec3f(elements[0][0] * point.x + elements[0][1] * point.y + elements[0][2] * point.z + elements[0][3],
+		elements[1][0] * point.x + elements[1][1] * point.y + elements[1][2] * point.z + elements[1][3],
+		elements[2][0] * point.x + elements[2][1] * point.y + elements[2][2] * point.z + elements[2][3]);
+}
+
+inline Vec3f AffineTransform::multiplyWithVector(const Vec3f& vector) const
+{
+	return Vec3f(elements[0][0] * vector.x + elements[0][1] * vector.y + elements[0][2] * vector.z,
+		elements[1][0] * vector.x + elements[1][1] * vector.y + elements[1][2] * vector.z,
+		elements[2][0] * vector.x + elements[2][1] * vector.y + elements[2][2] * vector.z);
+}
+
+inline Vec3f AffineTransform::multiplyWithNormal(const Vec3f& normal) const
+{
+	// Inverse transpose, the columns of the inverse are used as rows.
+	return Vec3f(inverseElements[0][0] * normal.x + inverseElements[1][0] * normal.y + inverseElements[2][0] * normal.z,
+		inverseElements[0][1] * normal.x + inverseElements[1][1] * normal.y + inverseElements[2][1] * normal.z,
+		inverseElements[0][2] * normal.x + inverseElements[1][2] * normal.y + inverseElements[2][2] * normal.z);
+}
+
+inline Vec3f AffineTransform::inverseMultiplyWithPoint(const Vec3f& point) const
+{
+	return Vec3f(inverseElements[0][0] * point.x + inverseElements[0][1] * point.y + inverseElements[0][2] * point.z + inverseElements[0][3],
+		inverseElements[1][0] * point.x + inverseElements[1][1] * point.y + inverseElements[1][2] * point.z + inverseElements[1][3],
+		inverseElements[2][0] * point.x + inverseElements[2][1] * point.y + inverseElements[2][2] * point.z + inverseElements[2][3]);
+}
+
+inline Vec3f AffineTransform::inverseMultiplyWithVector(const Vec3f& vector) const
+{
+	return Vec3f(inverseElements[0][0] * vector.x + inverseElements[0][1] * vector.y + inverseElements[0][2] * vector.z,
+		inverseElements[1][0] * vector.x + inverseElements[1][1] * vector.y + inverseElements[1][2] * vector.z,
+		inverseElements[2][0] * vector.x + inverseElements[2][1] * vector.y + inverseElements[2][2] * vector.z);
+}
+
+#endif
@@ -1,8 +1,5 @@
 #include "Light.h"
-
-// Each thread works on separate wi and pointOnLight objects.
-thread_local Vec3f AreaLight::wi;
-thread_local Vec3f AreaLight::pointOnLight;
+#include "LightBVH.h"
 
 AreaLight::AreaLight(const Vec3f& position_, const Vec3f& normal_, float extent_, const Vec3f& radiance_)
 	: position(position_), normal(normal_), extent(extent_), radiance(radiance_)
@@ -14,39 +11,45 @@ AreaLight::AreaLight(const Vec3f& position_, const Vec3f& normal_, float extent_
 
 	u = nPrime.crossProduct(normal).unitVector();
 	v = u.crossProduct(normal).unitVector();
-
-	// Initialize uniform random distribution to sample points on the surface of the area light later.
-	randGenerator.seed(std::chrono::system_clock::now().time_since_epoch().count());
-	distribution = std::uniform_real_distribution<float>(-0.5f, 0.5f);
 }
 
-Vec3f AreaLight::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample AreaLight::sample(const Vec3f& intersectionPoint, const Vec3f&, const Vec2f& e) const
 {
 	// Sample a uniform random point on area light.
-	float e1 = distribution(randGenerator);
-	float e2 = distribution(randGenerator);
-	pointOnLight = position + extent * (e1 * u + e2 * v);
+	float e1 = e.x - 0.5f;
+	float e2 = e.y - 0.5f;
+	Vec3f pointOnLight = position + extent * (e1 * u + e2 * v);
 
-	wi = (pointOnLight - intersectionPoint).unitVector();
-	return wi;
-}
+	LightSample lightSample;
+	Vec3f l = pointOnLight - intersectionPoint;
+	lightSample.distance = l.length();
+	lightSample.wi = l / lightSample.distance;
+	lightSample.radiance = radiance;
 
-float AreaLight::calculateDistance(const Vec3f& intersectionPoint)
-{
-	float dist = (pointOnLight - intersectionPoint).length();
-	return dist;
-}
-
-Vec3f AreaLight::calculateIrradiance(const Vec3f& intersectionPoint)
-{
+	// Convert the area pdf to solid angle, light emits from both sides.
 	float area = extent * extent;
-	float lightDistance = calculateDistance(intersectionPoint);
+	float cosThetaArea = abs(lightSample.wi.dotProduct(this->normal));
+	if (cosThetaArea > 0.0f)
+	{
+		lightSample.pdf = (lightSample.distance * lightSample.distance) / (area * cosThetaArea);
+	}
 
-	// wi is already computed when calculateWi was called.
-	Vec3f l = -1 * wi;
-	float cosThetaArea = abs(l.dotProduct(normal));
-	float dwi = (area * cosThetaArea) / (lightDistance * lightDistance);
-	Vec3f irradiance = radiance * dwi;
+	return lightSample;
+}
 
-	return irradiance;
+bool AreaLight::getLightBounds(LightBounds& lightBounds) const
+{
+	// Square emits from both sides, like calculateIrradiance.
+	Vec3f halfU = (extent / 2.0f) * u;
+	Vec3f halfV = (extent / 2.0f) * v;
+	lightBounds.bounds = BoundingBox(position, position);
+	lightBounds.bounds.mergeBoundingBox(BoundingBox(position + halfU + halfV, position + halfU + halfV));
+	lightBounds.bounds.mergeBoundingBox(BoundingBox(position + halfU - halfV, position + halfU - halfV));
+	lightBounds.bounds.mergeBoundingBox(BoundingBox(position - halfU + halfV, position - halfU + halfV));
+	lightBounds.bounds.mergeBoundingBox(BoundingBox(position - halfU - halfV, position - halfU - halfV));
+	lightBounds.axis = normal.unitVector();
+	lightBounds.cosThetaO = -1.0f;
+	lightBounds.cosThetaE = 0.0f;
+	lightBounds.power = 2.0f * PI * extent * extent * radiance.getAvg();
+	return true;
 }
\ No newline at end of file
@@ -1,5 +1,103 @@
 #include "BRDF.h"
 
+Vec3f BRDF::sample(const Hit& hit, const Material& material, const Vec3f& wo, const Vec2f& e, float& pdf) const
+{
+	// Choose the lobe with e.x and rescale it, so that it can be reused for the direction.
+	float diffuseWeight = material.diffuse.getMax();
+	float specularWeight = material.specular.getMax();
+	float specularProbability = (specularWeight > 0.0f) ? specularWeight / (diffuseWeight + specularWeight) : 0.0f;
+
+	Vec3f wi;
+	if (e.x < specularProbability)
+	{
+		wi = sampleSpecular(hit, wo, Vec2f(e.x / specularProbability, e.y));
+	}
+	else
+	{
+		wi = sampleCosinePower(hit.normal, 1.0f, Vec2f((e.x - specularProbability) / (1.0f - specularProbability), e.y));
+	}
+
+	pdf = this->pdf(hit, material, wi, wo);
+	return wi;
+}
+
+float BRDF::pdf(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo) const
+{
+	// Both lobes could have generated wi, the pdf of the mixture is returned.
+	float diffuseWeight = material.diffuse.getMax();
+	float specularWeight = material.specular.getMax();
+	float specularProbability = (specularWeight > 0.0f) ? specularWeight / (diffuseWeight + specularWeight) : 0.0f;
+
+	float diffusePdf = cosinePowerPdf(wi.dotProduct(hit.normal), 1.0f);
+	if (specularProbability == 0.0f)
+	{
+		return diffusePdf;
+	}
+
+	return (1.0f - specularProbability) * diffusePdf + specularProbability * specularPdf(hit, wi, wo);
+}
+
+Vec3f BRDF::sampleCosinePower(const Vec3f& axis, float exponent, const Vec2f& e)
+{
+	float phi = 2 * PI * e.x;
+	float cosAlpha = pow(e.y, 1.0f / (exponent + 1.0f));
+	float sinAlpha = sqrt(std::max(0.0f, 1.0f - cosAlpha * cosAlpha));
+
+	// Construct orthonormal basis uvw.
+	Vec3f w = axis;
+	Vec3f wPrime = w;
+	int minIdx = wPrime.getAbsMinElementIndex();
+	wPrime[minIdx] = 1.0f;
+
+	Vec3f u = wPrime.crossProduct(w).unitVector();
+	Vec3f v = u.crossProduct(w).unitVector();
+
+	return (w * cosAlpha + v * sinAlpha * cos(phi) + u * sinAlpha * sin(phi)).unitVector();
+}
+
+float BRDF::cosinePowerPdf(float cosAlpha, float exponent)
+{
+	if (cosAlpha <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return ((exponent + 1.0f) / (2 * PI)) * pow(cosAlpha, exponent);
+}
+
+Vec3f BRDF::sampleReflectionLobe(const Hit& hit, const Vec3f& wo, float exponent, const Vec2f& e)
+{
+	// cosAlphaR is symmetric in wi and wo, so wi is sampled around the mirror direction of wo.
+	Vec3f wr = (2 * (hit.normal * (wo.dotProduct(hit.normal))) - wo).unitVector();
+	return sampleCosinePower(wr, exponent, e);
+}
+
+float BRDF::reflectionLobePdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo, float exponent)
+{
+	Vec3f wr = (2 * (hit.normal * (wo.dotProduct(hit.normal))) - wo).unitVector();
+	return cosinePowerPdf(wi.dotProduct(wr), exponent);
+}
+
+Vec3f BRDF::sampleHalfVectorLobe(const Hit& hit, const Vec3f& wo, float exponent, const Vec2f& e)
+{
+	// Sample the half vector around the normal and reflect wo about it.
+	Vec3f wh = sampleCosinePower(hit.normal, exponent, e);
+	return (2 * (wh * (wo.dotProduct(wh))) - wo).unitVector();
+}
+
+float BRDF::halfVectorLobePdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo, float exponent)
+{
+	Vec3f wh = (wi + wo).unitVector();
+	float cosBeta = wo.dotProduct(wh);
+	if (cosBeta <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// Change of variables from the half vector to wi.
+	return cosinePowerPdf(wh.dotProduct(hit.normal), exponent) / (4 * cosBeta);
+}
+
 Vec3f PhongBRDF::getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const
 {
 	Vec3f brdfValue = Vec3f();
@@ -21,6 +119,16 @@ Vec3f PhongBRDF::getBRDFValue(const Hit& hit, const Material& material, const Ve
 	return irradiance * brdfValue * cosTheta;
 }
 
+Vec3f PhongBRDF::sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const
+{
+	return sampleReflectionLobe(hit, wo, exponent, e);
+}
+
+float PhongBRDF::specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const
+{
+	return reflectionLobePdf(hit, wi, wo, exponent);
+}
+
 Vec3f ModifiedPhongBRDF::getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const
 {
 	Vec3f brdfValue = Vec3f();
@@ -49,6 +157,16 @@ Vec3f ModifiedPhongBRDF::getBRDFValue(const Hit& hit, const Material& material,
 	return irradiance * brdfValue * cosTheta;
 }
 
+Vec3f ModifiedPhongBRDF::sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const
+{
+	return sampleReflectionLobe(hit, wo, exponent, e);
+}
+
+float ModifiedPhongBRDF::specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const
+{
+	return reflectionLobePdf(hit, wi, wo, exponent);
+}
+
 Vec3f BlinnPhongBRDF::getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const
 {
 	Vec3f brdfValue = Vec3f();
@@ -70,6 +188,16 @@ Vec3f BlinnPhongBRDF::getBRDFValue(const Hit& hit, const Material& material, con
 	return irradiance * brdfValue * cosTheta;
 }
 
+Vec3f BlinnPhongBRDF::sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const
+{
+	return sampleHalfVectorLobe(hit, wo, exponent, e);
+}
+
+float BlinnPhongBRDF::specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const
+{
+	return halfVectorLobePdf(hit, wi, wo, exponent);
+}
+
 Vec3f ModifiedBlinnPhongBRDF::getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const
 {
 	Vec3f brdfValue = Vec3f();
@@ -96,4 +224,14 @@ Vec3f ModifiedBlinnPhongBRDF::getBRDFValue(const Hit& hit, const Material& mater
 	// Else: brdf value is (0,0,0).
 
 	return irradiance * brdfValue * cosTheta;
+}
+
+Vec3f ModifiedBlinnPhongBRDF::sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const
+{
+	return sampleHalfVectorLobe(hit, wo, exponent, e);
+}
+
+float ModifiedBlinnPhongBRDF::specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const
+{
+	return halfVectorLobePdf(hit, wi, wo, exponent);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef BRDF_H_
 #define BRDF_H_
 
+#include "Vec2f.h"
 #include "Vec3f.h"
 #include "Ray.h"
 #include "Hit.h"
@@ -10,6 +11,23 @@ class BRDF
 {
 public:
 	virtual Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const = 0;
+
+	// Importance sampling, a cosine weighted diffuse lobe and the glossy lobe of the model are chosen by their weights in the material.
+	// e is a uniform random point in [0,1)^2, pdf is the solid angle pdf of the returned wi.
+	Vec3f sample(const Hit& hit, const Material& material, const Vec3f& wo, const Vec2f& e, float& pdf) const;
+	float pdf(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo) const;
+
+protected:
+	virtual Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const = 0;
+	virtual float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const = 0;
+
+	// Lobes shared by the models, directions around an axis with pdf (exponent + 1) / (2 * PI) * cos^exponent.
+	static Vec3f sampleCosinePower(const Vec3f& axis, float exponent, const Vec2f& e);
+	static float cosinePowerPdf(float cosAlpha, float exponent);
+	static Vec3f sampleReflectionLobe(const Hit& hit, const Vec3f& wo, float exponent, const Vec2f& e);
+	static float reflectionLobePdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo, float exponent);
+	static Vec3f sampleHalfVectorLobe(const Hit& hit, const Vec3f& wo, float exponent, const Vec2f& e);
+	static float halfVectorLobePdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo, float exponent);
 };
 
 class PhongBRDF : public BRDF
@@ -18,6 +36,10 @@ public:
 	PhongBRDF(float exponent_) : exponent(exponent_) {}
 	Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const;
 
+protected:
+	Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const;
+	float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const;
+
 private:
 	float exponent;
 };
@@ -28,6 +50,10 @@ public:
 	ModifiedPhongBRDF(float exponent_, bool normalized_) : exponent(exponent_), normalized(normalized_) {}
 	Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const;
 
+protected:
+	Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const;
+	float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const;
+
 private:
 	float exponent;
 	bool normalized;
@@ -39,6 +65,10 @@ public:
 	BlinnPhongBRDF(float exponent_) : exponent(exponent_) {}
 	Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const;
 
+protected:
+	Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const;
+	float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const;
+
 private:
 	float exponent;
 };
@@ -49,6 +79,10 @@ public:
 	ModifiedBlinnPhongBRDF(float exponent_, bool normalized_) : exponent(exponent_), normalized(normalized_) {}
 	Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const;
 
+protected:
+	Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const;
+	float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const;
+
 private:
 	float exponent;
 	bool normalized;
@@ -60,6 +94,10 @@ public:
 	TorranceSparrowBRDF(float exponent_, bool kdfresnel_) : exponent(exponent_), kdfresnel(kdfresnel_) {}
 	Vec3f getBRDFValue(const Hit& hit, const Material& material, const Vec3f& wi, const Vec3f& wo, const Vec3f& irradiance) const;
 
+protected:
+	Vec3f sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const;
+	float specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const;
+
 private:
 	float exponent;
 	bool kdfresnel;
@@ -1,7 +1,67 @@
 #include "BVH.h"
+#include "Triangle.h"
+#include "Sphere.h"
+#include "LightSphere.h"
+#include "Mesh.h"
+#include "LightMesh.h"
+#include "MeshInstance.h"
 
-BVH::BVH(std::vector<Object*>& objects, int start, int end, int axis)
+// Children are dispatched on their type tag, so every call below is direct and can be inlined.
+// Lights intersect like their geometry, they only differ in occlusion.
+static inline bool intersectObject(Object* object, const Ray& ray, RayHit& hit)
 {
+	// Inner nodes are the most common children, they are tested before the switch.
+	if (object->type == OBJECTTYPE_BVH)
+	{
+		return static_cast<BVH*>(object)->intersection(ray, hit);
+	}
+
+	switch (object->type)
+	{
+	case OBJECTTYPE_TRIANGLE:
+		return static_cast<Triangle*>(object)->intersection(ray, hit);
+	case OBJECTTYPE_SPHERE:
+	case OBJECTTYPE_LIGHTSPHERE:
+		return static_cast<Sphere*>(object)->Sphere::intersection(ray, hit);
+	case OBJECTTYPE_MESH:
+	case OBJECTTYPE_LIGHTMESH:
+		return static_cast<Mesh*>(object)->Mesh::intersection(ray, hit);
+	case OBJECTTYPE_MESHINSTANCE:
+		return static_cast<MeshInstance*>(object)->intersection(ray, hit);
+	default:
+		return object->intersection(ray, hit);
+	}
+}
+
+static inline bool occludeObject(Object* object, const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	if (object->type == OBJECTTYPE_BVH)
+	{
+		return static_cast<BVH*>(object)->occlusion(ray, tMax, ignoredLight);
+	}
+
+	switch (object->type)
+	{
+	case OBJECTTYPE_TRIANGLE:
+		return static_cast<Triangle*>(object)->occlusion(ray, tMax, ignoredLight);
+	case OBJECTTYPE_SPHERE:
+		return static_cast<Sphere*>(object)->Sphere::occlusion(ray, tMax, ignoredLight);
+	case OBJECTTYPE_LIGHTSPHERE:
+		return static_cast<LightSphere*>(object)->LightSphere::occlusion(ray, tMax, ignoredLight);
+	case OBJECTTYPE_MESH:
+		return static_cast<Mesh*>(object)->Mesh::occlusion(ray, tMax, ignoredLight);
+	case OBJECTTYPE_LIGHTMESH:
+		return static_cast<LightMesh*>(object)->LightMesh::occlusion(ray, tMax, ignoredLight);
+	case OBJECTTYPE_MESHINSTANCE:
+		return static_cast<MeshInstance*>(object)->occlusion(ray, tMax, ignoredLight);
+	default:
+		return object->occlusion(ray, tMax, ignoredLight);
+	}
+}
+
+BVH::BVH(MemoryArena& arena, std::vector<Object*>& objects, int start, int end, int axis)
+{
+	type = OBJECTTYPE_BVH;
 	int numberOfObjects = end - start;
 
 	if (numberOfObjects == 0)
@@ -49,12 +109,12 @@ BVH::BVH(std::vector<Object*>& objects, int start, int end, int axis)
 			mid = start + (end - start) / 2;
 		}
 
-		left = new BVH(objects, start, mid, (axis + 1) % 3);
-		right = new BVH(objects, mid, end, (axis + 1) % 3);
+		left = arena.create<BVH>(arena, objects, start, mid, (axis + 1) % 3);
+		right = arena.create<BVH>(arena, objects, mid, end, (axis + 1) % 3);
 	}
 }
 
-bool BVH::intersection(const Ray& ray, Hit& hit)
+bool BVH::intersection(const Ray& ray, RayHit& hit)
 {
 	bool result = false;
 	float t = boundingBox.intersection(ray);
@@ -64,40 +124,39 @@ bool BVH::intersection(const Ray& ray, Hit& hit)
 		return result;
 	}
 
-	if (left)
+	// Children update the hit in place, so the right child only accepts intersections closer than the left one.
+	if (left && intersectObject(left, ray, hit) == true)
 	{
-		Hit hitLeft = Hit();
-		bool leftResult = left->intersection(ray, hitLeft);
-		if (leftResult == true && hitLeft.t < hit.t && hitLeft.t > 0.0f)
-		{
-			hit = hitLeft;
-			result = true;
-		}
+		result = true;
 	}
 
-	if (right)
+	if (right && intersectObject(right, ray, hit) == true)
 	{
-		Hit hitRight = Hit();
-		bool rightResult = right->intersection(ray, hitRight);
-		if (rightResult == true && hitRight.t < hit.t && hitRight.t > 0.0f)
-		{
-			hit = hitRight;
-			result = true;
-		}
+		result = true;
 	}
 
 	return result;
 }
 
-BVH::~BVH()
+bool BVH::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
 {
-	if (left)
+	float t = boundingBox.intersection(ray);
+	if (t < 0.0f || t == kInf)
+	{
+		// No intersection with this bounding box
+		return false;
+	}
+
+	// Stop at the first blocking object, the closest one is not needed.
+	if (left && occludeObject(left, ray, tMax, ignoredLight) == true)
 	{
-		delete left;
+		return true;
 	}
 
-	if (right)
+	if (right && occludeObject(right, ray, tMax, ignoredLight) == true)
 	{
-		delete right;
+		return true;
 	}
+
+	return false;
 }
\ No newline at end of file
@@ -2,19 +2,20 @@
 #define BVH_H_
 
 #include "Object.h"
+#include "MemoryArena.h"
 #include <vector>
 
 
-class BVH : public Object
+class BVH final : public Object
 {
 public:
 	Object* left;				// pointer to left child
 	Object* right;				// pointer to right child
 	// bounding box for the current BVH node is derived from base class Object
 
-	BVH(std::vector<Object*>& objects, int start, int end, int axis);
-	bool intersection(const Ray& ray, Hit& hit);
-	~BVH();
+	BVH(MemoryArena& arena, std::vector<Object*>& objects, int start, int end, int axis);	// nodes are allocated from the arena
+	bool intersection(const Ray& ray, RayHit& hit);
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
 };
 
 
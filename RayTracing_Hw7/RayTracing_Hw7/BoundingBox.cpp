@@ -63,42 +63,20 @@ void BoundingBox::mergeBoundingBox(const BoundingBox& boundingBox)
 	center = (minCorner + maxCorner) / 2;
 }
 
-std::vector<Vec3f> BoundingBox::getVertices() const
+void BoundingBox::applyTransformation(const AffineTransform& transformation)
 {
-	std::vector<Vec3f> vertices;
-	vertices.push_back(minCorner);
-	vertices.push_back(Vec3f(minCorner.x, minCorner.y, maxCorner.z));
-	vertices.push_back(Vec3f(minCorner.x, maxCorner.y, minCorner.z));
-	vertices.push_back(Vec3f(minCorner.x, maxCorner.y, maxCorner.z));
-	vertices.push_back(Vec3f(maxCorner.x, minCorner.y, minCorner.z));
-	vertices.push_back(Vec3f(maxCorner.x, minCorner.y, maxCorner.z));
-	vertices.push_back(Vec3f(maxCorner.x, maxCorner.y, minCorner.z));
-	vertices.push_back(maxCorner);
-
-	return vertices;
-}
-
-void BoundingBox::applyTransformation(const Matrix4f& transformationMat)
-{
-	std::vector<Vec3f> vertices = getVertices();
-
-	// Apply transformation to all vertices.
-	for (int i = 0; i < vertices.size(); i++)
-	{
-		vertices[i] = transformationMat.multiplyWithPoint(vertices[i]);
-	}
-
-	// Vertex coordinates are changed, find new min and max corners.
-	minCorner = vertices[0];
-	maxCorner = vertices[0];
-	for (int i = 1; i < vertices.size(); i++)
-	{
-		minCorner.x = std::min(minCorner.x, vertices[i].x);
-		minCorner.y = std::min(minCorner.y, vertices[i].y);
-		minCorner.z = std::min(minCorner.z, vertices[i].z);
-
-		maxCorner.x = std::max(maxCorner.x, vertices[i].x);
-		maxCorner.y = std::max(maxCorner.y, vertices[i].y);
-		maxCorner.z = std::max(maxCorner.z, vertices[i].z);
-	}
+	// Transform the center and the half diagonal, the half diagonal extends by the absolute values of the matrix.
+	Vec3f halfDiagonal = (maxCorner - minCorner) / 2.0f;
+	Vec3f newCenter = transformation.multiplyWithPoint((minCorner + maxCorner) / 2.0f);
+	Vec3f axisX = transformation.multiplyWithVector(Vec3f(halfDiagonal.x, 0.0f, 0.0f));
+	Vec3f axisY = transformation.multiplyWithVector(Vec3f(0.0f, halfDiagonal.y, 0.0f));
+	Vec3f axisZ = transformation.multiplyWithVector(Vec3f(0.0f, 0.0f, halfDiagonal.z));
+	Vec3f newHalfDiagonal = Vec3f(std::abs(axisX.x) + std::abs(axisY.x) + std::abs(axisZ.x),
+		std::abs(axisX.y) + std::abs(axisY.y) + std::abs(axisZ.y),
+		std::abs(axisX.z) + std::abs(axisY.z) + std::abs(axisZ.z));
+
+	minCorner = newCenter - newHalfDiagonal;
+	maxCorner = newCenter + newHalfDiagonal;
+	diagonal = maxCorner - minCorner;
+	center = newCenter;
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define BOUNDINGBOX_H_
 
 #include "Ray.h"
-#include "Matrix4f.h"
+#include "AffineTransform.h"
 #include <vector>
 
 class BoundingBox
@@ -17,9 +17,7 @@ public:
 	BoundingBox(Vec3f minCorner_, Vec3f maxCorner_);
 	float intersection(const Ray& ray);
 	void mergeBoundingBox(const BoundingBox& boundingBox);
-	void applyTransformation(const Matrix4f& transformationMat);
-private:
-	std::vector<Vec3f> getVertices() const;
+	void applyTransformation(const AffineTransform& transformation);
 };
 
 #endif
\ No newline at end of file
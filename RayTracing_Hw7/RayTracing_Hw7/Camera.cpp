@@ -1,4 +1,6 @@
 #include "Camera.h"
+#include <algorithm>
+#include <cmath>
 
 void Camera::setCameraParams()
 {
@@ -20,4 +22,33 @@ bool Camera::hasDepthOfField() const
 {
 	// If aperture size is zero, return false.
 	return apertureSize;
+}
+
+void Camera::scaleResolution(float scale)
+{
+	// Image plane stays the same, only the number of pixels changes.
+	imageWidth = std::max(1, (int)(imageWidth * scale + 0.5f));
+	imageHeight = std::max(1, (int)(imageHeight * scale + 0.5f));
+}
+
+void Camera::cropImage(float minX, float maxX, float minY, float maxY)
+{
+	// Crop window in pixels, y points down as the rows of the image.
+	int x0 = std::min((int)(minX * imageWidth), imageWidth - 1);
+	int x1 = std::max((int)ceil(maxX * imageWidth), x0 + 1);
+	int y0 = std::min((int)(minY * imageHeight), imageHeight - 1);
+	int y1 = std::max((int)ceil(maxY * imageHeight), y0 + 1);
+
+	// Shrink the image plane to the window, so that the rendered pixels are the same as in the full image.
+	float pixelWidth = (right - left) / imageWidth;
+	float pixelHeight = (top - bottom) / imageHeight;
+	float croppedLeft = left + x0 * pixelWidth;
+	float croppedTop = top - y0 * pixelHeight;
+	right = left + x1 * pixelWidth;
+	bottom = top - y1 * pixelHeight;
+	left = croppedLeft;
+	top = croppedTop;
+
+	imageWidth = x1 - x0;
+	imageHeight = y1 - y0;
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 #include "Vec3f.h"
 #include "Tonemap.h"
+#include "Material.h"
 #include <string>
+#include <vector>
 
 enum Orientation
 {
@@ -41,6 +43,11 @@ public:
 	bool nextEventEstimation;
 	bool russianRoulette;
 	bool importanceSampling;
+	bool multipleImportanceSampling;	// combine light and BRDF samples with the power heuristic
+	bool wavefront;		// path tracing is done breadth-first over the samples of a tile
+	bool raySorting;	// secondary rays of a wavefront are sorted by direction and origin before tracing
+	bool lightTree;		// one light is chosen from the light BVH per shading point instead of shading with all lights
+	std::vector<Material> materials;	// materials of the scene in linear space for the tonemap of this camera, see Scene::setCameraMaterials
 
 	Camera() {}
 	Camera(Vec3f p, Vec3f g, Vec3f v, float l, float r, float b, float t, float d, int w, int h, std::string n, int ns, float as, float fd, const Tonemap& tm, const Orientation& ori)
@@ -48,6 +55,8 @@ public:
 		numberOfSamples(ns), apertureSize(as), focusDistance(fd), tonemap(tm), orientation(ori) {}
 	void setCameraParams();
 	bool hasDepthOfField() const;
+	void scaleResolution(float scale);
+	void cropImage(float minX, float maxX, float minY, float maxY);
 };
 
 #endif
\ No newline at end of file
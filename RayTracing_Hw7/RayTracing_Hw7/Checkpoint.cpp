@@ -0,0 +1,90 @@
+#include "Checkpoint.h"
+#include <fstream>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+static const char checkpointMagic[4] = { 'R', 'T', 'C', 'K' };
+static const int checkpointVersion = 1;
+
+static bool replaceFile(const std::string& source, const std::string& destination)
+{
+	// The destination is replaced in a single step, there is no moment without a checkpoint on disk.
+#ifdef _WIN32
+	return MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+}
+
+bool Checkpoint::readCheckpoint(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	char magic[4];
+	int version;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	if (!file || std::equal(magic, magic + 4, checkpointMagic) == false || version != checkpointVersion)
+	{
+		return false;
+	}
+
+	file.read((char*)&width, sizeof(width));
+	file.read((char*)&height, sizeof(height));
+	file.read((char*)&numberOfSamples, sizeof(numberOfSamples));
+	file.read((char*)&completedPasses, sizeof(completedPasses));
+	file.read((char*)&samplerSeed, sizeof(samplerSeed));
+	if (!file || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	accumulation = std::vector<Vec3f>(width * height, Vec3f());
+	file.read((char*)&accumulation[0], sizeof(Vec3f) * accumulation.size());
+
+	// A truncated file means the job was killed while writing, do not use it.
+	return (bool)file;
+}
+
+bool Checkpoint::writeCheckpoint(const std::string& filename) const
+{
+	// Write to a temporary file first, so that a crash during writing does not destroy the previous checkpoint.
+	std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+
+		file.write(checkpointMagic, sizeof(checkpointMagic));
+		file.write((const char*)&checkpointVersion, sizeof(checkpointVersion));
+		file.write((const char*)&width, sizeof(width));
+		file.write((const char*)&height, sizeof(height));
+		file.write((const char*)&numberOfSamples, sizeof(numberOfSamples));
+		file.write((const char*)&completedPasses, sizeof(completedPasses));
+		file.write((const char*)&samplerSeed, sizeof(samplerSeed));
+		file.write((const char*)&accumulation[0], sizeof(Vec3f) * accumulation.size());
+
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	return replaceFile(tempFilename, filename);
+}
+
+bool Checkpoint::matches(int width_, int height_, int numberOfSamples_, int numberOfPasses_) const
+{
+	// A finished render has no checkpoint, so at least one pass has to remain.
+	return width == width_ && height == height_ && numberOfSamples == numberOfSamples_ && completedPasses >= 0 && completedPasses < numberOfPasses_;
+}
@@ -0,0 +1,27 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "Vec3f.h"
+#include <string>
+#include <vector>
+
+// Snapshot of a partially rendered image, written periodically so that long renders can be resumed.
+class Checkpoint
+{
+public:
+	int width;
+	int height;
+	int numberOfSamples;
+	int completedPasses;			// number of sample passes accumulated so far
+	unsigned int samplerSeed;		// seed the samplers of the render are derived from
+	std::vector<Vec3f> accumulation;	// sum of the radiance samples of each pixel
+
+	Checkpoint() : width(0), height(0), numberOfSamples(0), completedPasses(0), samplerSeed(0) {}
+	Checkpoint(int width_, int height_, int numberOfSamples_, int completedPasses_, unsigned int samplerSeed_, const std::vector<Vec3f>& accumulation_)
+		: width(width_), height(height_), numberOfSamples(numberOfSamples_), completedPasses(completedPasses_), samplerSeed(samplerSeed_), accumulation(accumulation_) {}
+	bool readCheckpoint(const std::string& filename);
+	bool writeCheckpoint(const std::string& filename) const;
+	bool matches(int width_, int height_, int numberOfSamples_, int numberOfPasses_) const;
+};
+
+#endif
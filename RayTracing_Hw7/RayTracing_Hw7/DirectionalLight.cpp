@@ -1,18 +1,12 @@
 #include "Light.h"
 
-Vec3f DirectionalLight::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample DirectionalLight::sample(const Vec3f&, const Vec3f&, const Vec2f&) const
 {
-	Vec3f wi = (-1 * direction).unitVector();
-	return wi;
-}
+	LightSample lightSample;
+	lightSample.wi = (-1 * direction).unitVector();
+	lightSample.distance = std::numeric_limits<float>::max();
+	lightSample.radiance = radiance;
+	lightSample.pdf = 1.0f;
 
-float DirectionalLight::calculateDistance(const Vec3f& intersectionPoint)
-{
-	float dist = std::numeric_limits<float>::max();
-	return dist;
-}
-
-Vec3f DirectionalLight::calculateIrradiance(const Vec3f& intersectionPoint)
-{
-	return radiance;
+	return lightSample;
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "Distribution.h"
+#include <algorithm>
+#include <stdexcept>
+
+Distribution1D::Distribution1D(const float* values, int count)
+	: function(values, values + count), cdf(count + 1)
+{
+	cdf[0] = 0.0f;
+	for (int i = 1; i <= count; i++)
+	{
+		cdf[i] = cdf[i - 1] + function[i - 1] / count;
+	}
+
+	functionIntegral = cdf[count];
+	if (functionIntegral == 0.0f)
+	{
+		// All values are zero, fall back to a uniform distribution.
+		for (int i = 1; i <= count; i++)
+		{
+			cdf[i] = (float)i / count;
+		}
+	}
+	else
+	{
+		for (int i = 1; i <= count; i++)
+		{
+			cdf[i] /= functionIntegral;
+		}
+	}
+}
+
+float Distribution1D::sampleContinuous(float u, float& pdf, int& offset) const
+{
+	// Find the last cdf entry that is less than or equal to u.
+	offset = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin() - 1;
+	offset = std::max(0, std::min(size() - 1, offset));
+
+	float du = u - cdf[offset];
+	float width = cdf[offset + 1] - cdf[offset];
+	if (width > 0.0f)
+	{
+		du /= width;
+	}
+
+	pdf = (functionIntegral > 0.0f) ? function[offset] / functionIntegral : 1.0f;
+	return std::min((offset + du) / size(), 0.99999994f);
+}
+
+Distribution2D::Distribution2D(const float* values, int width, int height)
+{
+	conditionals.reserve(height);
+	for (int j = 0; j < height; j++)
+	{
+		conditionals.push_back(Distribution1D(values + j * width, width));
+	}
+
+	std::vector<float> rowIntegrals(height);
+	for (int j = 0; j < height; j++)
+	{
+		rowIntegrals[j] = conditionals[j].functionIntegral;
+	}
+	marginal = Distribution1D(rowIntegrals.data(), height);
+}
+
+Vec2f Distribution2D::sampleContinuous(float u1, float u2, float& pdf) const
+{
+	float pdfs[2];
+	int v;
+	int u;
+	float sampleV = marginal.sampleContinuous(u2, pdfs[1], v);
+	float sampleU = conditionals[v].sampleContinuous(u1, pdfs[0], u);
+
+	pdf = pdfs[0] * pdfs[1];
+	return Vec2f(sampleU, sampleV);
+}
+
+float Distribution2D::pdf(const Vec2f& uv) const
+{
+	int u = std::max(0, std::min(conditionals[0].size() - 1, (int)(uv.x * conditionals[0].size())));
+	int v = std::max(0, std::min(marginal.size() - 1, (int)(uv.y * marginal.size())));
+
+	if (marginal.functionIntegral == 0.0f)
+	{
+		return 1.0f;
+	}
+	return conditionals[v].function[u] / marginal.functionIntegral;
+}
+
+AliasTable::AliasTable(const float* weights, int count)
+	: probabilities(count, 1.0f), aliases(count), pmf(count)
+{
+	// sample has to return a valid index, so there must be at least one bin. All zero weights are sampled uniformly.
+	if (count <= 0)
+	{
+		throw std::runtime_error("Error: Alias table is built without weights.");
+	}
+
+	float sum = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		sum += weights[i];
+	}
+
+	// Scale the probabilities so that the average bin is 1, then fill the bins that are below 1 from the ones above 1.
+	std::vector<float> scaled(count);
+	std::vector<int> small;
+	std::vector<int> large;
+	for (int i = 0; i < count; i++)
+	{
+		pmf[i] = (sum > 0.0f) ? weights[i] / sum : 1.0f / count;
+		scaled[i] = pmf[i] * count;
+		aliases[i] = i;
+
+		if (scaled[i] < 1.0f)
+		{
+			small.push_back(i);
+		}
+		else
+		{
+			large.push_back(i);
+		}
+	}
+
+	while (small.empty() == false && large.empty() == false)
+	{
+		int s = small.back();
+		small.pop_back();
+		int l = large.back();
+		large.pop_back();
+
+		probabilities[s] = scaled[s];
+		aliases[s] = l;
+
+		scaled[l] = (scaled[l] + scaled[s]) - 1.0f;
+		if (scaled[l] < 1.0f)
+		{
+			small.push_back(l);
+		}
+		else
+		{
+			large.push_back(l);
+		}
+	}
+
+	// Remaining bins are full, up to rounding errors.
+	for (size_t i = 0; i < small.size(); i++)
+	{
+		probabilities[small[i]] = 1.0f;
+	}
+	for (size_t i = 0; i < large.size(); i++)
+	{
+		probabilities[large[i]] = 1.0f;
+	}
+}
+
+int AliasTable::sample(float u) const
+{
+	float remapped;
+	return sample(u, remapped);
+}
+
+int AliasTable::sample(float u, float& remapped) const
+{
+	// Integer part of u * size selects the bin, fractional part decides between the bin and its alias.
+	float scaledU = u * size();
+	int bin = std::min((int)scaledU, size() - 1);
+	float remainder = std::min(scaledU - bin, 0.99999994f);
+
+	if (remainder < probabilities[bin])
+	{
+		remapped = remainder / probabilities[bin];
+		return bin;
+	}
+
+	remapped = std::min((remainder - probabilities[bin]) / (1.0f - probabilities[bin]), 0.99999994f);
+	return aliases[bin];
+}
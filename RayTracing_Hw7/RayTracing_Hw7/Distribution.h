@@ -0,0 +1,51 @@
+#ifndef DISTRIBUTION_H_
+#define DISTRIBUTION_H_
+
+#include "Vec2f.h"
+#include <vector>
+
+// Piecewise constant distribution over [0,1], sampled by inverting its CDF.
+class Distribution1D
+{
+public:
+	std::vector<float> function;
+	std::vector<float> cdf;		// size + 1 entries, from 0 to 1
+	float functionIntegral;
+
+	Distribution1D() : functionIntegral(0.0f) {}
+	Distribution1D(const float* values, int count);
+	int size() const { return function.size(); }
+	float sampleContinuous(float u, float& pdf, int& offset) const;
+};
+
+// Piecewise constant distribution over [0,1]^2, values are given row by row.
+// A row is chosen with the marginal distribution, then a column with the conditional distribution of that row.
+class Distribution2D
+{
+public:
+	std::vector<Distribution1D> conditionals;
+	Distribution1D marginal;
+
+	Distribution2D(const float* values, int width, int height);
+	Vec2f sampleContinuous(float u1, float u2, float& pdf) const;
+	float pdf(const Vec2f& uv) const;
+};
+
+// Discrete distribution sampled in constant time with Vose's alias method.
+// Each bin keeps its own index with the given probability, otherwise it returns its alias.
+// The table needs at least one weight, if all weights are zero every index is equally likely.
+class AliasTable
+{
+public:
+	std::vector<float> probabilities;
+	std::vector<int> aliases;
+	std::vector<float> pmf;		// probability of drawing each index
+
+	AliasTable() {}
+	AliasTable(const float* weights, int count);
+	int size() const { return pmf.size(); }
+	int sample(float u) const;
+	int sample(float u, float& remapped) const;	// remapped is a new uniform number in [0,1) that can be used for the next choice
+};
+
+#endif
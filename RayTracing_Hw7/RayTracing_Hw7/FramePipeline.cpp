@@ -0,0 +1,121 @@
+#include "FramePipeline.h"
+#include <future>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstdlib>
+
+void FramePipeline::renderFrames()
+{
+	if (framePaths.empty())
+	{
+		return;
+	}
+
+	// Worker threads are shared by all frames.
+	ThreadPool threadPool(options.getNumberOfThreads());
+
+	std::future<Scene*> nextFrame = std::async(std::launch::async, &FramePipeline::loadFrame, this, framePaths[0]);
+	std::future<void> previousFrameWritten;
+
+	for (size_t i = 0; i < framePaths.size(); i++)
+	{
+		Scene* scene = nextFrame.get();
+
+		// Start parsing the next frame before rendering this one.
+		if (i + 1 < framePaths.size())
+		{
+			nextFrame = std::async(std::launch::async, &FramePipeline::loadFrame, this, framePaths[i + 1]);
+		}
+
+		try
+		{
+			scene->renderScene(threadPool);
+
+			// At most one frame is encoded at a time, wait for the previous one before handing over this frame.
+			if (previousFrameWritten.valid())
+			{
+				previousFrameWritten.get();
+			}
+		}
+		catch (...)
+		{
+			// The frame that is being loaded will not be rendered, free it once its parsing is done.
+			delete scene;
+			if (nextFrame.valid())
+			{
+				try
+				{
+					delete nextFrame.get();
+				}
+				catch (...)
+				{
+					// A frame that failed to load has already been freed by loadFrame.
+				}
+			}
+			throw;
+		}
+
+		previousFrameWritten = std::async(std::launch::async, &FramePipeline::writeFrame, scene);
+	}
+
+	previousFrameWritten.get();
+}
+
+Scene* FramePipeline::loadFrame(const std::string& filepath) const
+{
+	Scene* scene = new Scene();
+	scene->options = options;
+	scene->deferImageWriting = true;
+
+	try
+	{
+		scene->loadSceneFromXml(filepath);
+	}
+	catch (...)
+	{
+		delete scene;
+		throw;
+	}
+
+	return scene;
+}
+
+void FramePipeline::writeFrame(Scene* scene)
+{
+	scene->writeImages();
+	delete scene;
+}
+
+std::vector<std::string> FramePipeline::expandFramePattern(const std::string& pattern, int firstFrame, int lastFrame)
+{
+	// Pattern contains a single printf style integer field for the frame number, e.g. "water/tap_%04d.xml".
+	// The field is expanded here instead of passing the pattern to printf, so no other conversion is ever interpreted.
+	size_t fieldStart = pattern.find('%');
+	size_t fieldEnd = fieldStart + 1;
+	while (fieldStart != std::string::npos && fieldEnd < pattern.size() && isdigit((unsigned char)pattern[fieldEnd]))
+	{
+		fieldEnd++;
+	}
+	if (fieldStart == std::string::npos || fieldEnd == pattern.size() || pattern[fieldEnd] != 'd' || pattern.find('%', fieldEnd) != std::string::npos)
+	{
+		throw std::runtime_error("Error: Frame pattern must contain exactly one frame number field such as %d or %04d.");
+	}
+
+	std::string prefix = pattern.substr(0, fieldStart);
+	std::string suffix = pattern.substr(fieldEnd + 1);
+	std::string widthDigits = pattern.substr(fieldStart + 1, fieldEnd - fieldStart - 1);
+	int width = widthDigits.empty() ? 0 : atoi(widthDigits.c_str());
+	char fill = (widthDigits.empty() == false && widthDigits[0] == '0') ? '0' : ' ';
+
+	std::vector<std::string> paths;
+	for (int frame = firstFrame; frame <= lastFrame; frame++)
+	{
+		std::ostringstream path;
+		path << prefix << std::internal << std::setfill(fill) << std::setw(width) << frame << suffix;
+		paths.push_back(path.str());
+	}
+
+	return paths;
+}
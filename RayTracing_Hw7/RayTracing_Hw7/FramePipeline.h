@@ -0,0 +1,28 @@
+#ifndef FRAMEPIPELINE_H_
+#define FRAMEPIPELINE_H_
+
+#include "Scene.h"
+#include "ThreadPool.h"
+#include "RenderOptions.h"
+#include <string>
+#include <vector>
+
+// Renders a sequence of scene files (e.g. frames of an animation).
+// While frame N is rendered, frame N+1 is parsed and its BVH is built, and the images of frame N-1 are encoded.
+class FramePipeline
+{
+public:
+	std::vector<std::string> framePaths;
+	RenderOptions options;		// applied to every frame
+
+	FramePipeline(const std::vector<std::string>& framePaths_, const RenderOptions& options_)
+		: framePaths(framePaths_), options(options_) {}
+	void renderFrames();
+	static std::vector<std::string> expandFramePattern(const std::string& pattern, int firstFrame, int lastFrame);
+
+private:
+	Scene* loadFrame(const std::string& filepath) const;
+	static void writeFrame(Scene* scene);
+};
+
+#endif
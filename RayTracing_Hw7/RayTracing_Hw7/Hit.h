@@ -8,6 +8,7 @@
 class Material;
 class Texture;
 class Light;
+class Object;
 
 class Hit
 {
@@ -22,10 +23,23 @@ public:
 	Vec2f uvTexture;
 	bool isLight;	// true if the object hit is a LightMesh or a LightSphere
 	Vec3f radiance;	// radiance value of the object light
-	Light *lightObject;	// set this if the object hit is a LightMesh or a LightSphere
+	const Light* lightObject;	// set this if the object hit is a LightMesh or a LightSphere
 
 	Hit() : isLight(false), radiance(Vec3f()), t(kInf), texture(NULL), lightObject(NULL) {}
 };
 
+// Closest intersection found during traversal, objects overwrite it in place when they find a closer one.
+// Only what is needed to compute the Hit of the closest intersection afterwards is kept, see Object::getHit.
+class RayHit
+{
+public:
+	float t;					// intersections at or beyond t are rejected
+	const Object* primitive;	// triangle or sphere that is hit
+	const Object* instance;		// mesh or mesh instance the primitive is hit through, NULL if the primitive is in the scene bvh
+	Vec2f barycentrics;			// beta and gamma of a triangle hit
+
+	RayHit() : t(kInf), primitive(NULL), instance(NULL) {}
+};
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "KeyframedMotion.h"
+#include <cmath>
+#include <algorithm>
+
+Vec3f MotionKeyframe::transformPoint(const Vec3f& point) const
+{
+	return rotation.rotate(point * scaling) + translation;
+}
+
+Vec3f MotionKeyframe::transformNormal(const Vec3f& normal) const
+{
+	// Inverse transpose of rotation * scaling.
+	return rotation.rotate(normal / scaling);
+}
+
+Vec3f MotionKeyframe::inverseTransformPoint(const Vec3f& point) const
+{
+	return rotation.inverseRotate(point - translation) / scaling;
+}
+
+Vec3f MotionKeyframe::inverseTransformVector(const Vec3f& vector) const
+{
+	return rotation.inverseRotate(vector) / scaling;
+}
+
+KeyframedMotion::KeyframedMotion(const std::vector<MotionKeyframe>& keyframes_)
+	: keyframes(keyframes_)
+{
+	std::sort(keyframes.begin(), keyframes.end(),
+		[](const MotionKeyframe& a, const MotionKeyframe& b) { return a.time < b.time; });
+}
+
+MotionKeyframe KeyframedMotion::interpolate(float time) const
+{
+	// Hold the first and the last keyframe outside of their times.
+	if (time <= keyframes.front().time)
+	{
+		return keyframes.front();
+	}
+	if (time >= keyframes.back().time)
+	{
+		return keyframes.back();
+	}
+
+	int i = 0;
+	while (keyframes[i + 1].time < time)
+	{
+		i++;
+	}
+
+	const MotionKeyframe& k0 = keyframes[i];
+	const MotionKeyframe& k1 = keyframes[i + 1];
+	float t = (time - k0.time) / (k1.time - k0.time);
+
+	MotionKeyframe keyframe;
+	keyframe.time = time;
+	keyframe.translation = k0.translation * (1.0f - t) + k1.translation * t;
+	keyframe.rotation = Quaternion::slerp(k0.rotation, k1.rotation, t);
+	keyframe.scaling = k0.scaling * (1.0f - t) + k1.scaling * t;
+
+	return keyframe;
+}
+
+BoundingBox KeyframedMotion::getBoundingBox(const BoundingBox& boundingBox) const
+{
+	Vec3f corners[8];
+	for (int i = 0; i < 8; i++)
+	{
+		corners[i] = Vec3f((i & 1) ? boundingBox.maxCorner.x : boundingBox.minCorner.x,
+			(i & 2) ? boundingBox.maxCorner.y : boundingBox.minCorner.y,
+			(i & 4) ? boundingBox.maxCorner.z : boundingBox.minCorner.z);
+	}
+
+	BoundingBox motionBoundingBox;
+	for (size_t k = 0; k < keyframes.size(); k++)
+	{
+		// Translation and scaling are linear, so only rotation needs samples between the keyframes.
+		int numberOfSteps = 1;
+		float padding = 0.0f;
+		if (k + 1 < keyframes.size())
+		{
+			float angle = keyframes[k].rotation.getAngle(keyframes[k + 1].rotation);
+			numberOfSteps = std::max(1, (int)ceil(angle / (PI / 16.0f)));
+
+			// Corners move on arcs between the samples, pad by the sagitta of an arc of one step.
+			float radius = 0.0f;
+			const Vec3f& s0 = keyframes[k].scaling;
+			const Vec3f& s1 = keyframes[k + 1].scaling;
+			float maxScaling = std::max({ std::abs(s0.x), std::abs(s0.y), std::abs(s0.z), std::abs(s1.x), std::abs(s1.y), std::abs(s1.z) });
+			for (int i = 0; i < 8; i++)
+			{
+				radius = std::max(radius, corners[i].length() * maxScaling);
+			}
+			padding = radius * (1.0f - cos(angle / numberOfSteps / 2.0f));
+		}
+
+		for (int step = 0; step < numberOfSteps; step++)
+		{
+			float time = keyframes[k].time;
+			if (k + 1 < keyframes.size())
+			{
+				time += (keyframes[k + 1].time - keyframes[k].time) * step / numberOfSteps;
+			}
+
+			MotionKeyframe keyframe = interpolate(time);
+			for (int i = 0; i < 8; i++)
+			{
+				Vec3f corner = keyframe.transformPoint(corners[i]);
+				motionBoundingBox.mergeBoundingBox(BoundingBox(corner - padding, corner + padding));
+			}
+		}
+	}
+
+	return motionBoundingBox;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef KEYFRAMEDMOTION_H_
+#define KEYFRAMEDMOTION_H_
+
+#include "Vec3f.h"
+#include "Quaternion.h"
+#include "BoundingBox.h"
+#include <vector>
+
+// Transformation at one instant of the shutter, applied as translation * rotation * scaling.
+// Inverses are evaluated in closed form, no matrix is built.
+struct MotionKeyframe
+{
+	float time;
+	Vec3f translation;
+	Quaternion rotation;
+	Vec3f scaling;
+
+	MotionKeyframe() : time(0.0f), scaling(1.0f, 1.0f, 1.0f) {}
+	Vec3f transformPoint(const Vec3f& point) const;
+	Vec3f transformNormal(const Vec3f& normal) const;
+	Vec3f inverseTransformPoint(const Vec3f& point) const;
+	Vec3f inverseTransformVector(const Vec3f& vector) const;
+};
+
+// Motion of an object during the shutter, keyframes are interpolated at the time of the ray.
+// Translation and scaling are interpolated linearly, rotation with slerp along the shorter arc,
+// so a spin of more than 180 degrees needs more than two keyframes.
+class KeyframedMotion
+{
+public:
+	std::vector<MotionKeyframe> keyframes;	// sorted by time
+
+	KeyframedMotion(const std::vector<MotionKeyframe>& keyframes_);
+	MotionKeyframe interpolate(float time) const;
+	BoundingBox getBoundingBox(const BoundingBox& boundingBox) const;	// bounds of the box over the whole motion
+};
+
+#endif
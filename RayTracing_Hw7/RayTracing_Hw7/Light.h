@@ -1,17 +1,36 @@
 #ifndef LIGHT_H_
 #define LIGHT_H_
 
+#include "Vec2f.h"
 #include "Vec3f.h"
 #include "ImageTexture.h"
-#include <random>
-#include <chrono>
+#include "Distribution.h"
+
+class Hit;
+struct LightBounds;
+
+// Sample of a light towards a shading point.
+struct LightSample
+{
+	Vec3f wi;				// unit direction from the shading point to the light
+	float distance;			// distance to the sampled point, shadow rays stop before it
+	Vec3f radiance;			// light arriving along wi, the irradiance of the sample is radiance / pdf
+	float pdf;				// solid angle pdf of wi, 1 for lights with a single direction, 0 if the sample is invalid
+	bool intersectable;		// light is scene geometry that can be hit by rays, used by multiple importance sampling
+
+	LightSample() : distance(0.0f), pdf(0.0f), intersectable(false) {}
+};
 
 class Light
 {
 public:
-	virtual Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal) = 0;
-	virtual float calculateDistance(const Vec3f& intersectionPoint) = 0;
-	virtual Vec3f calculateIrradiance(const Vec3f& intersectionPoint) = 0;
+	virtual ~Light() {}
+
+	// Lights keep no state between calls, e is a uniform random point in [0,1)^2.
+	virtual LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const = 0;
+	virtual float calculateHitPdf(const Vec3f&, const Hit&) const { return 0.0f; }	// pdf of sampling the point hit by a ray
+
+	virtual bool getLightBounds(LightBounds&) const { return false; }	// bounds for the light BVH, false for lights at infinity
 };
 
 class PointLight : public Light
@@ -21,9 +40,8 @@ public:
 	Vec3f intensity;
 
 	PointLight(const Vec3f& position_, const Vec3f& intensity_) : position(position_), intensity(intensity_) {}
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	bool getLightBounds(LightBounds& lightBounds) const;
 };
 
 class AreaLight : public Light
@@ -37,15 +55,8 @@ public:
 	Vec3f v;
 
 	AreaLight(const Vec3f& position_, const Vec3f& normal_, float extent_, const Vec3f& radiance_);
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
-
-private:
-	static thread_local Vec3f wi;
-	static thread_local Vec3f pointOnLight;
-	std::default_random_engine randGenerator;
-	std::uniform_real_distribution<float> distribution;
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	bool getLightBounds(LightBounds& lightBounds) const;
 };
 
 class DirectionalLight : public Light
@@ -55,45 +66,37 @@ public:
 	Vec3f radiance;
 
 	DirectionalLight(const Vec3f& direction_, const Vec3f& radiance_) : direction(direction_), radiance(radiance_) {}
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
 };
 
 class SpotLight : public Light
 {
 public:
 	Vec3f position;
-	Vec3f direction;
+	Vec3f direction;	// unit length
 	Vec3f intensity;
 	float alpha;	// coverage angle
 	float beta;		// falloff angle
 
 	SpotLight(const Vec3f& position_, const Vec3f& direction_, const Vec3f& intensity_, float cAngle_, float fAngle_)
-		: position(position_), direction(direction_), intensity(intensity_), alpha(cAngle_), beta(fAngle_) {}
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
+		: position(position_), direction(direction_.unitVector()), intensity(intensity_), alpha(cAngle_), beta(fAngle_) {}
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	bool getLightBounds(LightBounds& lightBounds) const;
 
 private:
-	float calculateFalloff(const Vec3f& intersectionPoint);
+	float calculateFalloff(const Vec3f& wi) const;
 };
 
 class SphericalDirectionalLight : public Light
 {
 public:
 	ImageTexture *environmentMap;
+	Distribution2D *environmentDistribution;	// texels weighted by luminance and solid angle, built once in the constructor
 
 	SphericalDirectionalLight(const std::string& imagePath_);
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
-	Vec3f getTextureColor(const Vec3f& lDir);
-
-private:
-	static thread_local Vec3f l;
-	std::default_random_engine randGenerator;
-	std::uniform_real_distribution<float> distribution;
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	Vec3f getTextureColor(const Vec3f& lDir) const;
+	~SphericalDirectionalLight();
 };
 
 #endif
@@ -0,0 +1,252 @@
+#include "LightBVH.h"
+#include <algorithm>
+
+static float safeAcos(float x)
+{
+	return acos(std::max(-1.0f, std::min(1.0f, x)));
+}
+
+float LightBounds::importance(const Vec3f& point, const Vec3f& normal) const
+{
+	// Conservative estimate of the contribution of the lights in the bounds to a point with the given normal.
+	Vec3f pointToCenter = point - bounds.center;
+	float distanceSquare = pointToCenter.lengthSquared();
+	float radius = bounds.diagonal.length() / 2.0f;
+
+	// Do not let the importance grow without bound when the point is close to or inside the bounds.
+	float clampedDistanceSquare = std::max(std::max(distanceSquare, radius), 1e-6f);
+	Vec3f wi = (distanceSquare > 0.0f) ? pointToCenter / sqrt(distanceSquare) : Vec3f(0.0f, 0.0f, 1.0f);
+
+	// Angle subtended by the bounding sphere of the bounds.
+	float thetaB = PI;
+	if (distanceSquare > radius * radius)
+	{
+		thetaB = asin(sqrt((radius * radius) / distanceSquare));
+	}
+
+	// Smallest angle between an emission direction in the cone and the direction towards the point.
+	float thetaW = safeAcos(axis.dotProduct(wi));
+	float thetaO = safeAcos(cosThetaO);
+	float cosThetaX = cos(std::max(0.0f, thetaW - thetaO - thetaB));
+	if (cosThetaX <= cosThetaE)
+	{
+		return 0.0f;
+	}
+
+	// Smallest angle between the normal and a direction towards the bounds.
+	float thetaI = safeAcos(std::abs(wi.dotProduct(normal)));
+	float cosThetaI = cos(std::max(0.0f, thetaI - thetaB));
+
+	return power * cosThetaX * cosThetaI / clampedDistanceSquare;
+}
+
+LightBounds LightBounds::merge(const LightBounds& a, const LightBounds& b)
+{
+	// Lights that do not emit do not widen the bounds.
+	if (a.power == 0.0f)
+	{
+		return b;
+	}
+	if (b.power == 0.0f)
+	{
+		return a;
+	}
+
+	LightBounds merged;
+	merged.bounds = a.bounds;
+	merged.bounds.mergeBoundingBox(b.bounds);
+	merged.cosThetaE = std::min(a.cosThetaE, b.cosThetaE);
+	merged.power = a.power + b.power;
+
+	// Smallest cone that contains both normal cones.
+	float thetaA = safeAcos(a.cosThetaO);
+	float thetaB = safeAcos(b.cosThetaO);
+	float thetaD = safeAcos(a.axis.dotProduct(b.axis));
+
+	if (std::min(thetaD + thetaB, (float)PI) <= thetaA)
+	{
+		merged.axis = a.axis;
+		merged.cosThetaO = a.cosThetaO;
+		return merged;
+	}
+	if (std::min(thetaD + thetaA, (float)PI) <= thetaB)
+	{
+		merged.axis = b.axis;
+		merged.cosThetaO = b.cosThetaO;
+		return merged;
+	}
+
+	float thetaO = (thetaA + thetaD + thetaB) / 2.0f;
+	Vec3f rotationAxis = a.axis.crossProduct(b.axis);
+	if (thetaO >= PI || rotationAxis.lengthSquared() == 0.0f)
+	{
+		merged.axis = a.axis;
+		merged.cosThetaO = -1.0f;
+		return merged;
+	}
+
+	// Rotate the axis of a towards the axis of b (Rodrigues' formula).
+	float thetaR = thetaO - thetaA;
+	Vec3f k = rotationAxis.unitVector();
+	merged.axis = (a.axis * cos(thetaR) + k.crossProduct(a.axis) * sin(thetaR) + k * (k.dotProduct(a.axis) * (1.0f - cos(thetaR)))).unitVector();
+	merged.cosThetaO = cos(thetaO);
+
+	return merged;
+}
+
+LightBVHNode::LightBVHNode(LightBVHNode* left_, LightBVHNode* right_)
+	: left(left_), right(right_), parent(NULL), light(NULL)
+{
+	lightBounds = LightBounds::merge(left->lightBounds, right->lightBounds);
+	left->parent = this;
+	right->parent = this;
+}
+
+LightBVHNode::~LightBVHNode()
+{
+	if (left)
+	{
+		delete left;
+	}
+
+	if (right)
+	{
+		delete right;
+	}
+}
+
+LightBVH::LightBVH(const std::vector<Light*>& lights)
+	: root(NULL)
+{
+	std::vector<LightBVHNode*> nodes;
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		LightBounds lightBounds;
+		if (lights[i]->getLightBounds(lightBounds) == false)
+		{
+			infiniteLights.push_back(lights[i]);
+			continue;
+		}
+
+		LightBVHNode* leaf = new LightBVHNode(lights[i], lightBounds);
+		leaves[lights[i]] = leaf;
+		nodes.push_back(leaf);
+	}
+
+	if (nodes.empty() == false)
+	{
+		root = build(nodes, 0, nodes.size(), 0);
+	}
+}
+
+LightBVHNode* LightBVH::build(std::vector<LightBVHNode*>& nodes, int start, int end, int axis)
+{
+	if (end - start == 1)
+	{
+		return nodes[start];
+	}
+
+	// Split at the center of the bounds like the object BVH, cycling through the axes.
+	BoundingBox bounds = nodes[start]->lightBounds.bounds;
+	for (int i = start + 1; i < end; i++)
+	{
+		bounds.mergeBoundingBox(nodes[i]->lightBounds.bounds);
+	}
+
+	int mid = start;
+	float center = bounds.center[axis];
+	for (int i = start; i < end; i++)
+	{
+		if (nodes[i]->lightBounds.bounds.center[axis] < center)
+		{
+			std::swap(nodes[i], nodes[mid]);
+			mid++;
+		}
+	}
+
+	// If space partitioning fails, partition by taking the middle light.
+	if (mid == start || mid == end)
+	{
+		mid = start + (end - start) / 2;
+	}
+
+	LightBVHNode* left = build(nodes, start, mid, (axis + 1) % 3);
+	LightBVHNode* right = build(nodes, mid, end, (axis + 1) % 3);
+	return new LightBVHNode(left, right);
+}
+
+Light* LightBVH::sampleLight(const Vec3f& point, const Vec3f& normal, float u, float& pmf) const
+{
+	pmf = 0.0f;
+	if (root == NULL || root->lightBounds.importance(point, normal) == 0.0f)
+	{
+		return NULL;
+	}
+
+	// Descend the tree, u is rescaled at each level so it can be reused for the next choice.
+	LightBVHNode* node = root;
+	pmf = 1.0f;
+	while (node->light == NULL)
+	{
+		float leftImportance = node->left->lightBounds.importance(point, normal);
+		float rightImportance = node->right->lightBounds.importance(point, normal);
+		if (leftImportance + rightImportance == 0.0f)
+		{
+			pmf = 0.0f;
+			return NULL;
+		}
+
+		float leftProbability = leftImportance / (leftImportance + rightImportance);
+		if (u < leftProbability)
+		{
+			node = node->left;
+			pmf *= leftProbability;
+			u = std::min(u / leftProbability, 0.99999994f);
+		}
+		else
+		{
+			node = node->right;
+			pmf *= 1.0f - leftProbability;
+			u = std::min((u - leftProbability) / (1.0f - leftProbability), 0.99999994f);
+		}
+	}
+
+	return node->light;
+}
+
+float LightBVH::calculatePmf(const Vec3f& point, const Vec3f& normal, const Light* light) const
+{
+	// Probability that sampleLight returns the light, found by walking from its leaf up to the root.
+	auto leaf = leaves.find(light);
+	if (leaf == leaves.end() || root->lightBounds.importance(point, normal) == 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float pmf = 1.0f;
+	LightBVHNode* node = leaf->second;
+	while (node->parent)
+	{
+		LightBVHNode* parent = node->parent;
+		float leftImportance = parent->left->lightBounds.importance(point, normal);
+		float rightImportance = parent->right->lightBounds.importance(point, normal);
+		if (leftImportance + rightImportance == 0.0f)
+		{
+			return 0.0f;
+		}
+
+		float importance = (node == parent->left) ? leftImportance : rightImportance;
+		pmf *= importance / (leftImportance + rightImportance);
+		node = parent;
+	}
+
+	return pmf;
+}
+
+LightBVH::~LightBVH()
+{
+	if (root)
+	{
+		delete root;
+	}
+}
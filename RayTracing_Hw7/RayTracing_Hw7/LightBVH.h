@@ -0,0 +1,56 @@
+#ifndef LIGHTBVH_H_
+#define LIGHTBVH_H_
+
+#include "BoundingBox.h"
+#include "Light.h"
+#include <vector>
+#include <unordered_map>
+
+// Spatial and directional bounds of the emission of a light or a group of lights.
+struct LightBounds
+{
+	BoundingBox bounds;
+	Vec3f axis;			// normals of the emitters are within thetaO of axis
+	float cosThetaO;
+	float cosThetaE;	// emission falls to zero within thetaE beyond the normals
+	float power;
+
+	float importance(const Vec3f& point, const Vec3f& normal) const;
+	static LightBounds merge(const LightBounds& a, const LightBounds& b);
+};
+
+class LightBVHNode
+{
+public:
+	LightBounds lightBounds;
+	LightBVHNode* left;
+	LightBVHNode* right;
+	LightBVHNode* parent;
+	Light* light;		// light of a leaf, NULL for interior nodes
+
+	LightBVHNode(Light* light_, const LightBounds& lightBounds_)
+		: lightBounds(lightBounds_), left(NULL), right(NULL), parent(NULL), light(light_) {}
+	LightBVHNode(LightBVHNode* left_, LightBVHNode* right_);
+	~LightBVHNode();
+};
+
+// Hierarchy of the lights that have a position, used to pick one light per shading point.
+// The tree is descended with probabilities proportional to the estimated contribution of each child.
+class LightBVH
+{
+public:
+	std::vector<Light*> infiniteLights;		// directional and environment lights are not in the tree, they are always sampled
+
+	LightBVH(const std::vector<Light*>& lights);
+	Light* sampleLight(const Vec3f& point, const Vec3f& normal, float u, float& pmf) const;
+	float calculatePmf(const Vec3f& point, const Vec3f& normal, const Light* light) const;
+	~LightBVH();
+
+private:
+	LightBVHNode* root;
+	std::unordered_map<const Light*, LightBVHNode*> leaves;
+
+	static LightBVHNode* build(std::vector<LightBVHNode*>& nodes, int start, int end, int axis);
+};
+
+#endif
@@ -2,102 +2,124 @@
 #include "BVH.h"
 #include "Triangle.h"
 #include "Scene.h"
+#include "LightBVH.h"
+#include <stdexcept>
 
-// Each thread works on separate q, wi and pw objects.
-thread_local Vec3f LightMesh::q;
-thread_local Vec3f LightMesh::wi;
-thread_local float LightMesh::pw;
-
-LightMesh::LightMesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_)
-	: Mesh(scene_, materialId_, texture_, normalTexture_, triangles_, matrix_, transform_, motionVector_, motion_), radiance(radiance_)
+LightMesh::LightMesh(MemoryArena& arena, const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_)
+	: Mesh(arena, scene_, materialId_, texture_, normalTexture_, triangles_, transformation_, transform_, motionVector_, motion_), radiance(radiance_)
 {
-	// Initialize CDF for mesh triangles.
-	calculateCDF();
+	type = OBJECTTYPE_LIGHTMESH;
 
-	// Initialize uniform random distribution to sample points on the surface of the area light later.
-	randGenerator.seed(std::chrono::system_clock::now().time_since_epoch().count());
-	distribution = std::uniform_real_distribution<float>(0.0f, 1.0f);
+	// Initialize the triangle distribution for mesh triangles.
+	calculateCDF();
 }
 
 void LightMesh::calculateCDF()
 {
-	// Calculate CDF for triangles.
+	// Build the alias table for triangles.
 	// It will be used to select triangles with a probability proportional to their areas.
+	// Vertices and normals are transformed once here, so sampling does not touch the triangles.
 	totalArea = 0.0f;
+	std::vector<float> areas;
 
-	for (int i = 0; i < triangles.size(); i++)
+	worldVertices.clear();
+	worldNormals.clear();
+	for (size_t i = 0; i < triangles.size(); i++)
 	{
 		Triangle* triangle = dynamic_cast<Triangle*>(triangles[i]);
-		float area = triangle->getArea(transformationMatrix);
+
+		Vec3f a = transformation.multiplyWithPoint(scene->vertexPositions[triangle->v0]);
+		Vec3f b = transformation.multiplyWithPoint(scene->vertexPositions[triangle->v1]);
+		Vec3f c = transformation.multiplyWithPoint(scene->vertexPositions[triangle->v2]);
+		worldVertices.push_back(a);
+		worldVertices.push_back(b);
+		worldVertices.push_back(c);
+		worldNormals.push_back(transformation.multiplyWithNormal(triangle->normal).unitVector());
+
+		float area = triangle->getArea(transformation);
 		totalArea += area;
-		cdf.push_back(totalArea);
+		areas.push_back(area);
 	}
-	
-	// Divide by the total area, so that all elements are between 0 and 1 (used as probabilities).
-	for (int i = 0; i < cdf.size(); i++)
+
+	// The pdf of a sample divides by the total area.
+	if (totalArea <= 0.0f)
 	{
-		cdf[i] /= totalArea;
+		throw std::runtime_error("Error: LightMesh has zero area.");
 	}
+
+	triangleTable = AliasTable(areas.data(), areas.size());
 }
 
-Vec3f LightMesh::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample LightMesh::sample(const Vec3f& intersectionPoint, const Vec3f&, const Vec2f& e) const
 {
-	// Select a triangle randomly.
-	float rand = distribution(randGenerator);
-	Triangle* triangle = NULL;
-
-	for (int i = 0; i < cdf.size(); i++)
-	{
-		if (rand <= cdf[i])
-		{
-			triangle = dynamic_cast<Triangle*>(triangles[i]);
-			break;
-		}
-	}
-
-	// Transform vertices of the triangle.
-	Vec3f a = scene->vertexData[triangle->v0].position;
-	Vec3f b = scene->vertexData[triangle->v1].position;
-	Vec3f c = scene->vertexData[triangle->v2].position;
+	// Select a triangle randomly, the rest of e.x is reused for the point on the triangle.
+	float e1;
+	int triangleIdx = triangleTable.sample(e.x, e1);
+	float e2 = e.y;
 
-	Vec3f aNew = transformationMatrix.multiplyWithPoint(a);
-	Vec3f bNew = transformationMatrix.multiplyWithPoint(b);
-	Vec3f cNew = transformationMatrix.multiplyWithPoint(c);
+	const Vec3f& a = worldVertices[3 * triangleIdx];
+	const Vec3f& b = worldVertices[3 * triangleIdx + 1];
+	const Vec3f& c = worldVertices[3 * triangleIdx + 2];
 
 	// Sample a uniform random point on the selected triangle.
-	float e1 = distribution(randGenerator);
-	float e2 = distribution(randGenerator);
-	Vec3f p = (1.0f - e2) * bNew + e2 * cNew;
-	q = sqrt(e1) * p + (1.0f - sqrt(e1)) * aNew;
-
-	// Calculate p(w)
+	Vec3f p = (1.0f - e2) * b + e2 * c;
+	Vec3f q = sqrt(e1) * p + (1.0f - sqrt(e1)) * a;
+
+	LightSample lightSample;
+	lightSample.wi = (q - intersectionPoint).unitVector();
+	lightSample.distance = (q - scene->shadowRayEpsilon * lightSample.wi - intersectionPoint).length();
+	lightSample.radiance = radiance;
+	lightSample.intersectable = true;
+
+	// Calculate p(w), convert the area pdf to solid angle using the cosine at the light.
+	// Light emits from both sides, like the radiance returned by intersection.
+	const Vec3f& lightNormal = worldNormals[triangleIdx];
 	float rSquare = (q - intersectionPoint).lengthSquared();
-	float cosTheta = std::max(0.001f, triangle->normal.dotProduct(intersectionPoint - q));
-	pw = rSquare / (totalArea * cosTheta);
+	float cosTheta = std::max(0.001f, std::abs(lightNormal.dotProduct(lightSample.wi)));
+	lightSample.pdf = rSquare / (totalArea * cosTheta);
 
-	wi = (q - intersectionPoint).unitVector();
-	return wi;
+	return lightSample;
 }
 
-float LightMesh::calculateDistance(const Vec3f& intersectionPoint)
+float LightMesh::calculateHitPdf(const Vec3f& intersectionPoint, const Hit& lightHit) const
 {
-	float dist = (q - scene->shadowRayEpsilon * wi - intersectionPoint).length();
-	return dist;
-}
+	// Same density as sample, for the point found by a ray from intersectionPoint.
+	Vec3f l = lightHit.intersectionPoint - intersectionPoint;
+	float rSquare = l.lengthSquared();
+	float cosTheta = std::max(0.001f, std::abs(lightHit.normal.dotProduct(l.unitVector())));
 
-Vec3f LightMesh::calculateIrradiance(const Vec3f& intersectionPoint)
-{
-	Vec3f irradiance = radiance / pw;
-	return irradiance;
+	return rSquare / (totalArea * cosTheta);
 }
 
-bool LightMesh::intersection(const Ray& ray, Hit& hit)
+Hit LightMesh::getHit(const Ray& ray, const RayHit& rayHit) const
 {
-	bool result = Mesh::intersection(ray, hit);
+	Hit hit = Mesh::getHit(ray, rayHit);
 	hit.isLight = true;
 	hit.radiance = radiance;
 	hit.lightObject = this;
 
-	return result;
+	return hit;
+}
+
+bool LightMesh::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	// Light does not block the shadow rays sent towards itself.
+	if (ignoredLight == this)
+	{
+		return false;
+	}
+
+	return Mesh::occlusion(ray, tMax, ignoredLight);
+}
+
+bool LightMesh::getLightBounds(LightBounds& lightBounds) const
+{
+	// Triangles emit from both sides, so the normals are not bounded.
+	lightBounds.bounds = getBoundingBox();
+	lightBounds.axis = worldNormals.empty() ? Vec3f(0.0f, 0.0f, 1.0f) : worldNormals[0];
+	lightBounds.cosThetaO = -1.0f;
+	lightBounds.cosThetaE = 0.0f;
+	lightBounds.power = 2.0f * PI * totalArea * radiance.getAvg();
+	return true;
 }
\ No newline at end of file
@@ -9,23 +9,20 @@ class LightMesh : public Light, public Mesh
 public:
 	Vec3f radiance;
 
-	LightMesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_);
-	bool intersection(const Ray& ray, Hit& hit);
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
+	LightMesh(MemoryArena& arena, const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_);
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	float calculateHitPdf(const Vec3f& intersectionPoint, const Hit& lightHit) const;
+	bool getLightBounds(LightBounds& lightBounds) const;
 	void calculateCDF();
 
 private:
-	static thread_local Vec3f q;	// sampled point on light
-	static thread_local Vec3f wi;
-	static thread_local float pw;
-
 	float totalArea;
-	std::vector<float> cdf;
-	std::default_random_engine randGenerator;
-	std::uniform_real_distribution<float> distribution;
+	AliasTable triangleTable;				// selects triangles with a probability proportional to their areas
+	std::vector<Vec3f> worldVertices;		// three world space vertices per triangle
+	std::vector<Vec3f> worldNormals;
 };
 
 
@@ -1,26 +1,26 @@
 #include "LightSphere.h"
 #include "Scene.h"
+#include "LightBVH.h"
 
-// Each thread works on separate pointOnLight, wi and pw objects.
-thread_local Vec3f LightSphere::pointOnLight;
-thread_local Vec3f LightSphere::wi;
-thread_local float LightSphere::pw;
-
-Vec3f LightSphere::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample LightSphere::sample(const Vec3f& intersectionPoint, const Vec3f&, const Vec2f& e) const
 {
 	// Transform the intersection point to local (sphere) coordinates.
-	Vec3f localPoint = inverseTransformationMatrix.multiplyWithPoint(intersectionPoint);
-	Vec3f center = scene->vertexData[centerVertexId].position;
+	Vec3f localPoint = transformation.inverseMultiplyWithPoint(intersectionPoint);
 	Vec3f w = center - localPoint;
 	float d = w.length();
 
+	// Points inside the light cannot see a cone of it.
+	LightSample lightSample;
+	if (d <= radius)
+	{
+		return lightSample;
+	}
+
 	float sinThetaMax = radius / d;
 	float cosThetaMax = sqrt(1.0f - sinThetaMax * sinThetaMax);
 
-	pw = 1.0f / (2.0f * PI * (1.0f - cosThetaMax));
-
 	// Construct orthonormal basis uvw.
-	w = w.unitVector();
+	w = w / d;
 	Vec3f wPrime = w;
 	int minIdx = wPrime.getAbsMinElementIndex();
 	wPrime[minIdx] = 1.0f;
@@ -29,47 +29,67 @@ Vec3f LightSphere::calculateWi(const Vec3f& intersectionPoint, const Vec3f& norm
 	Vec3f v = u.crossProduct(w).unitVector();
 
 	// Compute phi and theta.
-	float e1 = distribution(randGenerator);
-	float e2 = distribution(randGenerator);
+	float phi = 2.0f * PI * e.x;
+	float cosTheta = 1.0f - e.y + e.y * cosThetaMax;
+	float sinTheta = sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
 
-	float phi = 2.0f * PI * e1;
-	float theta = acos(1.0f - e2 + e2 * cosThetaMax);
+	Vec3f lLocal = w * cosTheta + v * sinTheta * cos(phi) + u * sinTheta * sin(phi);
 
-	Vec3f lLocal = w * cos(theta) + v * sin(theta) * cos(phi) + u * sin(theta) * sin(phi);
-	Vec3f lWorld = transformationMatrix.multiplyWithVector(lLocal);
+	// Closest intersection of the sampled direction with the sphere, no ray has to be traced.
+	float distanceLocal = d * cosTheta - sqrt(std::max(0.0f, radius * radius - d * d * sinTheta * sinTheta));
+	Vec3f pointOnLight = transformation.multiplyWithPoint(localPoint + distanceLocal * lLocal);
 
-	// r(t) = pWorld + t.lWorld
-	// Intersect r(t) with the lightSphere and find the point on the light from which light is obtained.
-	Ray rayLight = Ray(intersectionPoint + scene->shadowRayEpsilon * lWorld.unitVector(), lWorld.unitVector());
-	Hit hitLight = Hit();
-	bool result = intersection(rayLight, hitLight);
-	if (result == true)
-	{
-		pointOnLight = hitLight.intersectionPoint;
-		wi = (hitLight.intersectionPoint - intersectionPoint).unitVector();
-	}
+	Vec3f l = pointOnLight - intersectionPoint;
+	lightSample.distance = l.length();
+	lightSample.wi = l / lightSample.distance;
+	lightSample.radiance = radiance;
+	lightSample.pdf = 1.0f / (2.0f * PI * (1.0f - cosThetaMax));
+	lightSample.intersectable = true;
 
-	return wi;
+	return lightSample;
 }
 
-float LightSphere::calculateDistance(const Vec3f& intersectionPoint)
+float LightSphere::calculateHitPdf(const Vec3f& intersectionPoint, const Hit&) const
 {
-	float dist = (pointOnLight - intersectionPoint).length();
-	return dist;
-}
+	// Directions are sampled uniformly in the cone around the sphere, so the pdf depends only on the shading point.
+	Vec3f localPoint = transformation.inverseMultiplyWithPoint(intersectionPoint);
+	float d = (center - localPoint).length();
 
-Vec3f LightSphere::calculateIrradiance(const Vec3f& intersectionPoint)
-{
-	Vec3f irradiance = radiance / pw;
-	return irradiance;
+	float sinThetaMax = radius / d;
+	float cosThetaMax = sqrt(std::max(0.0f, 1.0f - sinThetaMax * sinThetaMax));
+
+	return 1.0f / (2.0f * PI * (1.0f - cosThetaMax));
 }
 
-bool LightSphere::intersection(const Ray& ray, Hit& hit)
+Hit LightSphere::getHit(const Ray& ray, const RayHit& rayHit) const
 {
-	bool result = Sphere::intersection(ray, hit);
+	Hit hit = Sphere::getHit(ray, rayHit);
 	hit.isLight = true;
 	hit.radiance = radiance;
 	hit.lightObject = this;
 
-	return result;
+	return hit;
+}
+
+bool LightSphere::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	// Light does not block the shadow rays sent towards itself.
+	if (ignoredLight == this)
+	{
+		return false;
+	}
+
+	return Sphere::occlusion(ray, tMax, ignoredLight);
+}
+
+bool LightSphere::getLightBounds(LightBounds& lightBounds) const
+{
+	// Radius is estimated from the bounding box, it includes the transformations.
+	lightBounds.bounds = getBoundingBox();
+	float worldRadius = lightBounds.bounds.diagonal.length() / (2.0f * sqrt(3.0f));
+	lightBounds.axis = Vec3f(0.0f, 0.0f, 1.0f);
+	lightBounds.cosThetaO = -1.0f;
+	lightBounds.cosThetaE = 0.0f;
+	lightBounds.power = 4.0f * PI * PI * worldRadius * worldRadius * radiance.getAvg();
+	return true;
 }
\ No newline at end of file
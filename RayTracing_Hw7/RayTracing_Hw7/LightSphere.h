@@ -10,20 +10,13 @@ public:
 	Vec3f radiance;
 
 	LightSphere(const Scene* scene_, const int center_, float radius_, int material_, Texture* texture_, Texture* normalTexture_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_)
-		: Sphere(scene_, center_, radius_, material_, texture_, normalTexture_, matrix_, transform_, motionVector_, motion_), radiance(radiance_) {}
-	bool intersection(const Ray& ray, Hit& hit);
-	Vec3f calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal);
-	float calculateDistance(const Vec3f& intersectionPoint);
-	Vec3f calculateIrradiance(const Vec3f& intersectionPoint);
-
-private:
-	static thread_local Vec3f pointOnLight;
-	static thread_local Vec3f wi;
-	static thread_local float pw;
-
-	std::default_random_engine randGenerator;
-	std::uniform_real_distribution<float> distribution;
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_, const Vec3f& radiance_)
+		: Sphere(scene_, center_, radius_, material_, texture_, normalTexture_, transformation_, transform_, motionVector_, motion_), radiance(radiance_) { type = OBJECTTYPE_LIGHTSPHERE; }
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
+	LightSample sample(const Vec3f& intersectionPoint, const Vec3f& normal, const Vec2f& e) const;
+	float calculateHitPdf(const Vec3f& intersectionPoint, const Hit& lightHit) const;
+	bool getLightBounds(LightBounds& lightBounds) const;
 };
 
 
@@ -2,42 +2,83 @@
 #include "Vec3f.h"
 #include "Matrix4f.h"
 #include "Scene.h"
+#include "FramePipeline.h"
+#include "RenderOptions.h"
+#include "Statistics.h"
 #include <thread>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
 
-int main()
+int main(int argc, char* argv[])
 {
-	// Get xml file path from user.
-	/*std::string filepath;
-	std::cout << "Please provide input filepath:" << std::endl;
-	std::cin >> filepath;
-	
-	Scene scene;	
-	scene.loadSceneFromXml(filepath);
-	scene.renderScene();*/
+	RenderOptions options;
+	std::vector<std::string> scenePaths;
 
-	Scene scene;
-	std::string filepath = "SampleScenes/pathTracing/cornellbox_jaroslav_path_glass.xml";
-	//std::string filepath = "SampleScenes/directLighting/cornellbox_jaroslav_diffuse_area.xml";
-	//std::string filepath = "SampleScenes/veach_ajar/scene.xml";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+		{
+			RenderOptions::printUsage(argv[0]);
+			return 0;
+		}
+	}
 
-	scene.loadSceneFromXml(filepath);
+	try
+	{
+		options.parseArguments(argc, argv, scenePaths);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cout << e.what() << std::endl;
+		RenderOptions::printUsage(argv[0]);
+		return 1;
+	}
 
-	scene.renderScene();
+	if (scenePaths.empty())
+	{
+		scenePaths.push_back("SampleScenes/pathTracing/cornellbox_jaroslav_path_glass.xml");
+		//scenePaths.push_back("SampleScenes/directLighting/cornellbox_jaroslav_diffuse_area.xml");
+		//scenePaths.push_back("SampleScenes/veach_ajar/scene.xml");
+	}
 
-	/*for (int i = 243; i < 286; i++)
+	Statistics::countAllocations = options.printStatistics;
+	auto start = std::chrono::system_clock::now();
+
+	try
+	{
+		if (scenePaths.size() == 1)
+		{
+			Scene scene;
+			scene.options = options;
+			scene.loadSceneFromXml(scenePaths[0]);
+			scene.renderScene();
+		}
+		else
+		{
+			// Several scenes or the frames of an animation, next scene is loaded while the current one renders.
+			FramePipeline pipeline = FramePipeline(scenePaths, options);
+			pipeline.renderFrames();
+		}
+	}
+	catch (const std::exception& e)
 	{
-		Scene scene;
-		std::stringstream ss;
-		ss << std::setw(4) << std::setfill('0') << i;
-		std::string imageNumber = ss.str();
-		std::string filepath = "water_animation/smooth/tap_" + imageNumber + ".xml";
+		// Errors of loading or writing a frame are passed on by the pipeline.
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
 
-		scene.loadSceneFromXml(filepath);
+	if (options.printStatistics == true)
+	{
+		auto end = std::chrono::system_clock::now();
+		double seconds = std::chrono::duration<double>(end - start).count();
 
-		scene.renderScene();
-	}*/
+		std::cout << "Threads:        " << options.getNumberOfThreads() << std::endl;
+		std::cout << "Time (secs):    " << seconds << std::endl;
+		Statistics::printStatistics(std::cout, seconds);
+	}
 
 	return 0;
 }
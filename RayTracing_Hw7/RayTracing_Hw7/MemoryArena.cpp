@@ -0,0 +1,52 @@
+#include "MemoryArena.h"
+#include <cstdlib>
+#include <algorithm>
+
+MemoryArena::MemoryArena(size_t blockSize_)
+	: blockSize(blockSize_), current(NULL), remaining(0), allocatedBytes(0)
+{
+}
+
+void* MemoryArena::allocate(size_t size, size_t alignment)
+{
+	size_t padding = (alignment - (size_t)current % alignment) % alignment;
+	if (current == NULL || padding + size > remaining)
+	{
+		// Start a new block, objects larger than a block get a block of their own.
+		size_t newBlockSize = std::max(blockSize, size + alignment);
+		current = (char*)malloc(newBlockSize);
+		if (current == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		blocks.push_back(current);
+		remaining = newBlockSize;
+		padding = (alignment - (size_t)current % alignment) % alignment;
+	}
+
+	void* result = current + padding;
+	current += padding + size;
+	remaining -= padding + size;
+	allocatedBytes += size;
+
+	return result;
+}
+
+size_t MemoryArena::getAllocatedBytes() const
+{
+	return allocatedBytes;
+}
+
+MemoryArena::~MemoryArena()
+{
+	// Destroy in reverse order of creation, like objects on the stack.
+	for (int i = (int)destructors.size() - 1; i >= 0; i--)
+	{
+		destructors[i]();
+	}
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		free(blocks[i]);
+	}
+}
\ No newline at end of file
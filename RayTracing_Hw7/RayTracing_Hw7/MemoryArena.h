@@ -0,0 +1,46 @@
+#ifndef MEMORYARENA_H_
+#define MEMORYARENA_H_
+
+#include <vector>
+#include <functional>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Bump allocator for the geometry and the acceleration structures of a scene.
+// Objects are placed one after another in large blocks in the order they are created,
+// and all of them are released together when the arena is destroyed.
+class MemoryArena
+{
+public:
+	MemoryArena(size_t blockSize_ = 1 << 20);
+	void* allocate(size_t size, size_t alignment);
+	template <typename T, typename... Args>
+	T* create(Args&&... args);
+	size_t getAllocatedBytes() const;
+	~MemoryArena();
+
+private:
+	size_t blockSize;
+	char* current;		// next free byte of the current block
+	size_t remaining;	// free bytes left in the current block
+	size_t allocatedBytes;
+	std::vector<char*> blocks;
+	std::vector<std::function<void()>> destructors;	// only for objects that own memory of their own
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+};
+
+template <typename T, typename... Args>
+T* MemoryArena::create(Args&&... args)
+{
+	T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	if (std::is_trivially_destructible<T>::value == false)
+	{
+		destructors.push_back([object]() { object->~T(); });
+	}
+	return object;
+}
+
+#endif
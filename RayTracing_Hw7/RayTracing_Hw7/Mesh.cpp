@@ -1,11 +1,12 @@
 #include "Mesh.h"
 #include "BVH.h"
 
-Mesh::Mesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_)
-	: Object(scene_, materialId_, texture_, normalTexture_, matrix_, transform_, motionVector_, motion_), triangles(triangles_)
+Mesh::Mesh(MemoryArena& arena, const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_)
+	: Object(scene_, materialId_, texture_, normalTexture_, transformation_, transform_, motionVector_, motion_), triangles(triangles_)
 {
-	bvh = new BVH(triangles, 0, triangles.size(), 0);
+	type = OBJECTTYPE_MESH;
+	bvh = arena.create<BVH>(arena, triangles, 0, triangles.size(), 0);
 
 	// This sets only this mesh's bounding box, it does not affect the bvh's bounding box,
 	// no transformations are applied to bvh's bounding box.
@@ -13,7 +14,7 @@ Mesh::Mesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* nor
 	if (transform == true)
 	{
 		// Transform bounding box to world coords.
-		boundingBox.applyTransformation(transformationMatrix);
+		boundingBox.applyTransformation(transformation);
 	}
 
 	if (motionBlur == true)
@@ -25,23 +26,31 @@ Mesh::Mesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* nor
 	}
 }
 
-bool Mesh::intersection(const Ray& ray, Hit& hit)
+bool Mesh::intersection(const Ray& ray, RayHit& hit)
 {
+	// Transformed ray direction is not normalized, so t values are the same in local coordinates.
 	Ray transformedRay = transformRay(ray);
 
 	bool result = bvh->intersection(transformedRay, hit);
 	if (result == true)
 	{
-		hit = transformHit(hit, transformedRay.time);
+		hit.instance = this;
 	}
 
 	return result;
 }
 
-Mesh::~Mesh()
+Hit Mesh::getHit(const Ray& ray, const RayHit& rayHit) const
 {
-	if (bvh)
-	{
-		delete bvh;
-	}
+	Ray transformedRay = transformRay(ray);
+	Hit hit = rayHit.primitive->getHit(transformedRay, rayHit);
+
+	return transformHit(hit, transformedRay.time);
+}
+
+bool Mesh::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	// Transformed ray direction is not normalized, so t values are the same in local coordinates.
+	Ray transformedRay = transformRay(ray);
+	return bvh->occlusion(transformedRay, tMax, ignoredLight);
 }
\ No newline at end of file
@@ -2,19 +2,22 @@
 #define MESH_H_
 
 #include "Triangle.h"
+#include "BVH.h"
+#include "MemoryArena.h"
 #include <vector>
 
 class Mesh : public Object
 {
 public:
 	std::vector<Object*> triangles;
-	Object* bvh;
+	BVH* bvh;
 
-	Mesh() {}
-	Mesh(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_);
-	bool intersection(const Ray& ray, Hit& hit);
-	~Mesh();
+	Mesh() { type = OBJECTTYPE_MESH; }
+	Mesh(MemoryArena& arena, const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, std::vector<Object*> triangles_,
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_);
+	bool intersection(const Ray& ray, RayHit& hit);
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
 };
 
 #endif
\ No newline at end of file
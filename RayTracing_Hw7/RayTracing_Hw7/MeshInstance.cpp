@@ -1,15 +1,16 @@
 #include "MeshInstance.h"
 
-MeshInstance::MeshInstance(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, Object* baseMeshBVH_,
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_)
-	: Object(scene_, materialId_, texture_, normalTexture_, matrix_, transform_, motionVector_, motion_), baseMeshBVH(baseMeshBVH_)
+MeshInstance::MeshInstance(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, BVH* baseMeshBVH_,
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_)
+	: Object(scene_, materialId_, texture_, normalTexture_, transformation_, transform_, motionVector_, motion_), baseMeshBVH(baseMeshBVH_)
 {
+	type = OBJECTTYPE_MESHINSTANCE;
 	// Get base mesh's bvh's bounding box, which has no transformations applied.
 	boundingBox = baseMeshBVH->getBoundingBox();
 	if (transform == true)
 	{
 		// Transform bounding box to world coords.
-		boundingBox.applyTransformation(transformationMatrix);
+		boundingBox.applyTransformation(transformation);
 	}
 
 	if (motionBlur == true)
@@ -21,7 +22,7 @@ MeshInstance::MeshInstance(const Scene* scene_, int materialId_, Texture* textur
 	}
 }
 
-bool MeshInstance::intersection(const Ray& ray, Hit& hit)
+bool MeshInstance::intersection(const Ray& ray, RayHit& hit)
 {
 	// Apply transformations wrt this mesh instance.
 	Ray transformedRay = transformRay(ray);
@@ -29,21 +30,27 @@ bool MeshInstance::intersection(const Ray& ray, Hit& hit)
 	bool result = baseMeshBVH->intersection(transformedRay, hit);
 	if (result == true)
 	{
-		hit = transformHit(hit, transformedRay.time);
-
-		// Intersection is computed using base mesh's bvh, need to override object specific features like material and texture.
-		// Use this mesh instance's material instead of baseMesh's triangle's material.
-		hit.materialId = materialId;
-		hit.texture = texture;
+		hit.instance = this;
 	}
 
 	return result;
 }
 
-MeshInstance::~MeshInstance()
+Hit MeshInstance::getHit(const Ray& ray, const RayHit& rayHit) const
 {
-	if (baseMeshBVH)
-	{
-		delete baseMeshBVH;
-	}
+	Ray transformedRay = transformRay(ray);
+	Hit hit = transformHit(rayHit.primitive->getHit(transformedRay, rayHit), transformedRay.time);
+
+	// Intersection is computed using base mesh's bvh, need to override object specific features like material and texture.
+	// Use this mesh instance's material instead of baseMesh's triangle's material.
+	hit.materialId = materialId;
+	hit.texture = texture;
+
+	return hit;
+}
+
+bool MeshInstance::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	Ray transformedRay = transformRay(ray);
+	return baseMeshBVH->occlusion(transformedRay, tMax, ignoredLight);
 }
\ No newline at end of file
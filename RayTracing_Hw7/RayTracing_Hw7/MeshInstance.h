@@ -2,17 +2,19 @@
 #define MESHINSTANCE_H_
 
 #include "Object.h"
+#include "BVH.h"
 
-class MeshInstance : public Object
+class MeshInstance final : public Object
 {
 public:
-	Object* baseMeshBVH;
+	BVH* baseMeshBVH;
 
-	MeshInstance() {}
-	MeshInstance(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, Object* baseMeshBVH_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_);
-	bool intersection(const Ray& ray, Hit& hit);
-	~MeshInstance();
+	MeshInstance() { type = OBJECTTYPE_MESHINSTANCE; }
+	MeshInstance(const Scene* scene_, int materialId_, Texture* texture_, Texture* normalTexture_, BVH* baseMeshBVH_,
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_);
+	bool intersection(const Ray& ray, RayHit& hit);
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
 };
 
 #endif
@@ -2,13 +2,20 @@
 #include "Scene.h"
 
 Object::Object(const Scene* scene_, int mId_, Texture* texture_, Texture* normalTexture_, 
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_)
-	: scene(scene_), materialId(mId_), texture(texture_), normalTexture(normalTexture_), transformationMatrix(matrix_), transform(transform_), 
-	motionVector(motionVector_), motionBlur(motion_)
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_)
+	: scene(scene_), materialId(mId_), texture(texture_), normalTexture(normalTexture_), transformation(transformation_), transform(transform_), 
+	motionVector(motionVector_), motionBlur(motion_), keyframedMotion(NULL)
 {
-	// Compute inverse transformation matrix and normal transformation matrix
-	inverseTransformationMatrix = transformationMatrix.inverse();
-	normalTransformationMatrix = inverseTransformationMatrix.transpose();
+}
+
+bool Object::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	// Any hit in (0, tMax) blocks the shadow ray, lights skip the test themselves if they are being sampled.
+	// Objects without a cheaper test fall back to the closest hit.
+	RayHit hit = RayHit();
+	hit.t = tMax;
+
+	return intersection(ray, hit);
 }
 
 const BoundingBox& Object::getBoundingBox() const
@@ -16,33 +23,40 @@ const BoundingBox& Object::getBoundingBox() const
 	return boundingBox;
 }
 
+Hit Object::getHit(const Ray&, const RayHit&) const
+{
+	// Bvh nodes never end up in a hit, primitives and meshes override this.
+	return Hit();
+}
+
 Ray Object::transformRay(const Ray& ray) const
 {
 	// Transform ray to local coordinates.
 	Ray transformedRay = ray;
 
-	if (transform == false && motionBlur == false)
+	if (transform == false && motionBlur == false && keyframedMotion == NULL)
 	{
 		return transformedRay;
 	}
-	else if (transform == true && motionBlur == false)
+
+	if (keyframedMotion)
 	{
-		transformedRay.origin = inverseTransformationMatrix.multiplyWithPoint(ray.origin);
-		transformedRay.direction = inverseTransformationMatrix.multiplyWithVector(ray.direction);
+		MotionKeyframe keyframe = keyframedMotion->interpolate(ray.time);
+		transformedRay.origin = keyframe.inverseTransformPoint(ray.origin);
+		transformedRay.direction = keyframe.inverseTransformVector(ray.direction);
 	}
-	else if (motionBlur == true)
+
+	// Motion blur is a translation by motionVector * time applied after the transformation,
+	// so its inverse is a subtraction and no matrix has to be built or inverted per ray.
+	if (motionBlur == true)
 	{
-		Vec3f motionBlurDistance = motionVector * ray.time;
-		Translation translation = Translation(motionBlurDistance);
-		Matrix4f invFinalMatrix = translation.getTransformationMatrix().inverse();
-
-		if (transform == true)
-		{
-			invFinalMatrix = inverseTransformationMatrix * invFinalMatrix;
-		}
-		
-		transformedRay.origin = invFinalMatrix.multiplyWithPoint(ray.origin);
-		transformedRay.direction = invFinalMatrix.multiplyWithVector(ray.direction);
+		transformedRay.origin = transformedRay.origin - motionVector * ray.time;
+	}
+
+	if (transform == true)
+	{
+		transformedRay.origin = transformation.inverseMultiplyWithPoint(transformedRay.origin);
+		transformedRay.direction = transformation.inverseMultiplyWithVector(transformedRay.direction);
 	}
 
 	return transformedRay;
@@ -53,47 +67,36 @@ Hit Object::transformHit(const Hit& hit, float time) const
 	// Transform hit to world coordinates.
 	Hit transformedHit = hit;
 
-	if (transform == false && motionBlur == false)
+	if (transform == false && motionBlur == false && keyframedMotion == NULL)
 	{
 		return transformedHit;
 	}
-	else if (transform == true && motionBlur == false)
+
+	if (transform == true)
 	{
-		transformedHit.intersectionPoint = transformationMatrix.multiplyWithPoint(hit.intersectionPoint);
-		transformedHit.normal = (normalTransformationMatrix.multiplyWithVector(hit.normal)).unitVector();
+		transformedHit.intersectionPoint = transformation.multiplyWithPoint(hit.intersectionPoint);
+		transformedHit.normal = (transformation.multiplyWithNormal(hit.normal)).unitVector();
 	}
-	else if (transform == false && motionBlur == true)
+
+	// Translation does not change normals.
+	if (motionBlur == true)
 	{
-		Vec3f motionBlurDistance = motionVector * time;
-		Translation translation = Translation(motionBlurDistance);
-		Matrix4f motionMatrix = translation.getTransformationMatrix();
-		Matrix4f invMotionMatrix = motionMatrix.inverse();
-		Matrix4f normalMotionMatrix = invMotionMatrix.transpose();
-
-		transformedHit.intersectionPoint = motionMatrix.multiplyWithPoint(hit.intersectionPoint);
-		transformedHit.normal = (normalMotionMatrix.multiplyWithVector(hit.normal)).unitVector();
+		transformedHit.intersectionPoint = transformedHit.intersectionPoint + motionVector * time;
 	}
-	else
-	{
-		Vec3f motionBlurDistance = motionVector * time;
-		Translation translation = Translation(motionBlurDistance);
-		Matrix4f motionMatrix = translation.getTransformationMatrix();
-		Matrix4f invMotionMatrix = motionMatrix.inverse();
 
-		Matrix4f finalMatrix = motionMatrix * transformationMatrix;
-		Matrix4f finalNormalMatrix = (inverseTransformationMatrix * invMotionMatrix).transpose();
-
-		transformedHit.intersectionPoint = finalMatrix.multiplyWithPoint(hit.intersectionPoint);
-		transformedHit.normal = (finalNormalMatrix.multiplyWithVector(hit.normal)).unitVector();
+	if (keyframedMotion)
+	{
+		MotionKeyframe keyframe = keyframedMotion->interpolate(time);
+		transformedHit.intersectionPoint = keyframe.transformPoint(transformedHit.intersectionPoint);
+		transformedHit.normal = keyframe.transformNormal(transformedHit.normal).unitVector();
 	}
 
 	return transformedHit;
 }
 
-Object::~Object()
+void Object::setKeyframedMotion(KeyframedMotion* keyframedMotion_)
 {
-	if (texture)
-	{
-		delete texture;
-	}
+	// World bounds have to contain the object during the whole shutter for the BVH.
+	keyframedMotion = keyframedMotion_;
+	boundingBox = keyframedMotion->getBoundingBox(boundingBox);
 }
\ No newline at end of file
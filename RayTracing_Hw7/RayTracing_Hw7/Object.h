@@ -5,34 +5,50 @@
 #include "Ray.h"
 #include "Hit.h"
 #include "BoundingBox.h"
-#include "Matrix4f.h"
+#include "AffineTransform.h"
 #include "Texture.h"
+#include "KeyframedMotion.h"
 
 const float epsilon = 0.000001f;
 class Scene;
+class Light;
+
+// Concrete type of an object, bvh nodes dispatch on it instead of calling the virtual intersection routines.
+enum ObjectType
+{
+	OBJECTTYPE_BVH = 0,
+	OBJECTTYPE_TRIANGLE,
+	OBJECTTYPE_SPHERE,
+	OBJECTTYPE_LIGHTSPHERE,
+	OBJECTTYPE_MESH,
+	OBJECTTYPE_LIGHTMESH,
+	OBJECTTYPE_MESHINSTANCE
+};
 
 class Object
 {
 public:
+	ObjectType type;		// set by the constructor of each derived class
 	int materialId;
-	Texture* texture;		// Texture for shading
+	Texture* texture;		// Texture for shading, textures are owned by the scene
 	Texture* normalTexture;	// Texture for normal perturbation
-	Matrix4f transformationMatrix;
-	Matrix4f inverseTransformationMatrix;
-	Matrix4f normalTransformationMatrix;
+	AffineTransform transformation;		// keeps its inverse, which is also used for normals
 	bool transform;
 	Vec3f motionVector;
 	bool motionBlur;
+	KeyframedMotion* keyframedMotion;	// applied after the transformations and the motion blur translation, NULL if the object has no keyframes
 
-	Object() {}
-	//Object(const Scene* scene_, int id_, const Matrix4f& matrix_, bool transform_);
+	Object() : texture(NULL), normalTexture(NULL), keyframedMotion(NULL) {}
+	//Object(const Scene* scene_, int id_, const AffineTransform& transformation_, bool transform_);
 	Object(const Scene* scene_, int mId_, Texture* texture_, Texture* normalTexture_, 
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_);
-	virtual bool intersection(const Ray& ray, Hit& hit) = 0;
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_);
+	virtual bool intersection(const Ray& ray, RayHit& hit) = 0;
+	virtual Hit getHit(const Ray& ray, const RayHit& rayHit) const;	// full hit of an intersection found by this object
+	virtual bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
 	const BoundingBox& getBoundingBox() const;
 	Ray transformRay(const Ray& ray) const;
 	Hit transformHit(const Hit& hit, float time) const;
-	~Object();
+	void setKeyframedMotion(KeyframedMotion* keyframedMotion_);
 
 protected:
 	const Scene* scene;
@@ -0,0 +1,45 @@
+#include "OctahedralNormal.h"
+#include <cmath>
+#include <algorithm>
+
+static float signNotZero(float value)
+{
+	return (value >= 0.0f) ? 1.0f : -1.0f;
+}
+
+OctahedralNormal::OctahedralNormal(const Vec3f& normal)
+{
+	// Project onto the octahedron |x| + |y| + |z| = 1.
+	float l1Norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	float px = normal.x / l1Norm;
+	float py = normal.y / l1Norm;
+
+	// Fold the lower hemisphere over the diagonals.
+	if (normal.z < 0.0f)
+	{
+		float foldedX = (1.0f - std::abs(py)) * signNotZero(px);
+		float foldedY = (1.0f - std::abs(px)) * signNotZero(py);
+		px = foldedX;
+		py = foldedY;
+	}
+
+	x = (short)round(std::max(-1.0f, std::min(1.0f, px)) * 32767.0f);
+	y = (short)round(std::max(-1.0f, std::min(1.0f, py)) * 32767.0f);
+}
+
+Vec3f OctahedralNormal::decode() const
+{
+	float px = x / 32767.0f;
+	float py = y / 32767.0f;
+	float pz = 1.0f - std::abs(px) - std::abs(py);
+
+	if (pz < 0.0f)
+	{
+		float unfoldedX = (1.0f - std::abs(py)) * signNotZero(px);
+		float unfoldedY = (1.0f - std::abs(px)) * signNotZero(py);
+		px = unfoldedX;
+		py = unfoldedY;
+	}
+
+	return Vec3f(px, py, pz).unitVector();
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef OCTAHEDRALNORMAL_H_
+#define OCTAHEDRALNORMAL_H_
+
+#include "Vec3f.h"
+
+// Unit vector in 4 bytes, the direction is projected onto an octahedron whose lower half is folded over the upper half,
+// and the two coordinates are stored as 16 bit fixed point numbers in [-1, 1]. The angular error is below 0.0001 radians.
+class OctahedralNormal
+{
+public:
+	short x, y;
+
+	OctahedralNormal() : x(0), y(0) {}
+	OctahedralNormal(const Vec3f& normal);
+	Vec3f decode() const;	// unit vector
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "PathBuffer.h"
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+static void permute(std::vector<T>& values, const std::vector<int>& order, std::vector<char>& scratch)
+{
+	// All arrays go through the same byte buffer, so no memory is allocated once it is large enough.
+	static_assert(std::is_trivially_copyable<T>::value, "path states are copied as bytes");
+	scratch.resize(order.size() * sizeof(T));
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		memcpy(&scratch[i * sizeof(T)], &values[order[i]], sizeof(T));
+	}
+	memcpy(values.data(), scratch.data(), scratch.size());
+}
+
+void PathBuffer::clear()
+{
+	// Capacity is kept, so the buffers are not reallocated for the next tile.
+	origins.clear();
+	directions.clear();
+	times.clear();
+	insideObject.clear();
+	indirect.clear();
+	throughputs.clear();
+	lobePdfs.clear();
+	lobeNormals.clear();
+	pixelIndices.clear();
+	hits.clear();
+	hitFound.clear();
+	alive.clear();
+}
+
+void PathBuffer::addPath(const Ray& ray, int pixelIndex)
+{
+	origins.push_back(ray.origin);
+	directions.push_back(ray.direction);
+	times.push_back(ray.time);
+	insideObject.push_back(ray.isInsideObject);
+	indirect.push_back(ray.indirect);
+	throughputs.push_back(Vec3f(1.0f, 1.0f, 1.0f));
+	lobePdfs.push_back(0.0f);
+	lobeNormals.push_back(Vec3f());
+	pixelIndices.push_back(pixelIndex);
+	hits.push_back(Hit());
+	hitFound.push_back(false);
+	alive.push_back(true);
+}
+
+Ray PathBuffer::getRay(int i) const
+{
+	Ray ray = Ray(origins[i], directions[i], (bool)insideObject[i], times[i]);
+	ray.indirect = indirect[i];
+	return ray;
+}
+
+void PathBuffer::setRay(int i, const Ray& ray)
+{
+	origins[i] = ray.origin;
+	directions[i] = ray.direction;
+	times[i] = ray.time;
+	insideObject[i] = ray.isInsideObject;
+	indirect[i] = ray.indirect;
+}
+
+void PathBuffer::compact()
+{
+	// Move the alive paths to the front, keeping their order.
+	int count = 0;
+	for (int i = 0; i < size(); i++)
+	{
+		if (alive[i] == false)
+		{
+			continue;
+		}
+
+		if (count != i)
+		{
+			origins[count] = origins[i];
+			directions[count] = directions[i];
+			times[count] = times[i];
+			insideObject[count] = insideObject[i];
+			indirect[count] = indirect[i];
+			throughputs[count] = throughputs[i];
+			lobePdfs[count] = lobePdfs[i];
+			lobeNormals[count] = lobeNormals[i];
+			pixelIndices[count] = pixelIndices[i];
+			alive[count] = true;
+		}
+		count++;
+	}
+
+	origins.resize(count);
+	directions.resize(count);
+	times.resize(count);
+	insideObject.resize(count);
+	indirect.resize(count);
+	throughputs.resize(count);
+	lobePdfs.resize(count);
+	lobeNormals.resize(count);
+	pixelIndices.resize(count);
+	hits.resize(count);
+	hitFound.resize(count);
+	alive.resize(count);
+}
+
+void PathBuffer::reorder(const std::vector<int>& order)
+{
+	// Path i of the new order is path order[i] of the current order.
+	// Hits are not moved, they are written by the next extend stage.
+	permute(origins, order, permutedValues);
+	permute(directions, order, permutedValues);
+	permute(times, order, permutedValues);
+	permute(insideObject, order, permutedValues);
+	permute(indirect, order, permutedValues);
+	permute(throughputs, order, permutedValues);
+	permute(lobePdfs, order, permutedValues);
+	permute(lobeNormals, order, permutedValues);
+	permute(pixelIndices, order, permutedValues);
+	permute(alive, order, permutedValues);
+}
+
+void ShadowRayBuffer::clear()
+{
+	origins.clear();
+	directions.clear();
+	times.clear();
+	maxDistances.clear();
+	lights.clear();
+	contributions.clear();
+	pixelIndices.clear();
+}
+
+void ShadowRayBuffer::addRay(const Ray& ray, float maxDistance, const Light* light, const Vec3f& contribution, int pixelIndex)
+{
+	origins.push_back(ray.origin);
+	directions.push_back(ray.direction);
+	times.push_back(ray.time);
+	maxDistances.push_back(maxDistance);
+	lights.push_back(light);
+	contributions.push_back(contribution);
+	pixelIndices.push_back(pixelIndex);
+}
+
+Ray ShadowRayBuffer::getRay(int i) const
+{
+	return Ray(origins[i], directions[i], times[i]);
+}
@@ -0,0 +1,64 @@
+#ifndef PATHBUFFER_H_
+#define PATHBUFFER_H_
+
+#include "Vec3f.h"
+#include "Ray.h"
+#include "Hit.h"
+#include <vector>
+#include <utility>
+
+class Light;
+
+// States of the paths traced together by the wavefront path tracer, in structure of arrays layout.
+// Each stage reads only the arrays it needs, paths that are terminated are removed with compact.
+class PathBuffer
+{
+public:
+	// Current ray of each path
+	std::vector<Vec3f> origins;
+	std::vector<Vec3f> directions;
+	std::vector<float> times;
+	std::vector<char> insideObject;
+	std::vector<char> indirect;
+
+	std::vector<Vec3f> throughputs;
+	std::vector<float> lobePdfs;	// pdf of the current ray if it is sampled from the diffuse lobe, used by multiple importance sampling
+	std::vector<Vec3f> lobeNormals;	// normal at the origin of the current ray
+	std::vector<int> pixelIndices;	// pixel the path contributes to, relative to the image
+	std::vector<Hit> hits;			// closest hit of the current ray, written by the extend stage
+	std::vector<char> hitFound;
+	std::vector<char> alive;		// cleared by the shade stage when the path terminates
+
+	// Scratch memory of sorting and reordering, reused by every bounce of the tiles the buffer renders.
+	std::vector<std::pair<unsigned int, int>> sortKeys;
+	std::vector<int> sortOrder;
+	std::vector<char> permutedValues;
+
+	int size() const { return origins.size(); }
+	void clear();
+	void addPath(const Ray& ray, int pixelIndex);
+	Ray getRay(int i) const;
+	void setRay(int i, const Ray& ray);
+	void compact();
+	void reorder(const std::vector<int>& order);
+};
+
+// Shadow rays of next event estimation, the contribution is added to the pixel if the ray is not occluded.
+class ShadowRayBuffer
+{
+public:
+	std::vector<Vec3f> origins;
+	std::vector<Vec3f> directions;
+	std::vector<float> times;
+	std::vector<float> maxDistances;
+	std::vector<const Light*> lights;	// light the ray is sent to, it does not occlude its own shadow rays
+	std::vector<Vec3f> contributions;
+	std::vector<int> pixelIndices;
+
+	int size() const { return origins.size(); }
+	void clear();
+	void addRay(const Ray& ray, float maxDistance, const Light* light, const Vec3f& contribution, int pixelIndex);
+	Ray getRay(int i) const;
+};
+
+#endif
@@ -1,6 +1,10 @@
 #include "PerlinTexture.h"
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <emmintrin.h>
 
-PerlinNoise::PerlinNoise()
+PerlinNoise::PerlinNoise(unsigned int seed)
 {
 	// Fill gradient vector table G.
 	G[0] = Vec3f(1, 1, 0);
@@ -26,77 +30,139 @@ PerlinNoise::PerlinNoise()
 	// Fill P and shuffle the array.
 	for (int i = 0; i < 16; i++)
 	{
-		P.push_back(i);
+		P[i] = i;
 	}
 
 	std::mt19937 randomGenerator;
-	randomGenerator.seed(std::chrono::system_clock::now().time_since_epoch().count());
-	std::shuffle(P.begin(), P.end(), randomGenerator);
+	randomGenerator.seed(seed);
+	std::shuffle(P, P + 16, randomGenerator);
 }
 
 float PerlinNoise::getNoiseValue(const Vec3f& p) const
 {
 	float noise = 0.0f;
 
-	// Compute lattice points surrounding point p.
-	int x = floor(p.x);
-	int y = floor(p.y);
-	int z = floor(p.z);
-
-	std::vector<Vec3i> latticePoints;
-	latticePoints.push_back(Vec3i(x, y, z));
-	latticePoints.push_back(Vec3i(x, y, z + 1));
-	latticePoints.push_back(Vec3i(x, y + 1, z));
-	latticePoints.push_back(Vec3i(x, y + 1, z + 1));
-	latticePoints.push_back(Vec3i(x + 1, y, z));
-	latticePoints.push_back(Vec3i(x + 1, y, z + 1));
-	latticePoints.push_back(Vec3i(x + 1, y + 1, z));
-	latticePoints.push_back(Vec3i(x + 1, y + 1, z + 1));
-
-	for (int n = 0; n < latticePoints.size(); n++)
+	// Lattice point below p and the position of p in its cell.
+	float floorX = floor(p.x);
+	float floorY = floor(p.y);
+	float floorZ = floor(p.z);
+	int x = (int)floorX;
+	int y = (int)floorY;
+	int z = (int)floorZ;
+	Vec3f f = p - Vec3f(floorX, floorY, floorZ);
+
+	// Weights of the lower and the upper lattice point along each axis.
+	float wx[2] = { weight(f.x), weight(1.0f - f.x) };
+	float wy[2] = { weight(f.y), weight(1.0f - f.y) };
+	float wz[2] = { weight(f.z), weight(1.0f - f.z) };
+
+	// Eight corners of the cell, the bits of n select the upper lattice point along x, y and z.
+	for (int n = 0; n < 8; n++)
 	{
-		Vec3i latticePoint = latticePoints[n];
-		int i = latticePoint.x;
-		int j = latticePoint.y;
-		int k = latticePoint.z;
+		int dx = (n >> 2) & 1;
+		int dy = (n >> 1) & 1;
+		int dz = n & 1;
 
-		Vec3f e = getGradientVector(i, j, k);
-		Vec3f v = p - Vec3f((float)i, (float)j, (float)k);
+		const Vec3f& e = G[getGradientIndex(x + dx, y + dy, z + dz)];
+		Vec3f v = Vec3f(f.x - dx, f.y - dy, f.z - dz);
 
-		noise += e.dotProduct(v) * weight(v.x) * weight(v.y) * weight(v.z);
+		noise += e.dotProduct(v) * wx[dx] * wy[dy] * wz[dz];
 	}
 
 	return noise;
 }
 
-float PerlinNoise::weight(float x) const
+void PerlinNoise::getNoiseValues(const Vec3f* points, float* noises, int count) const
 {
-	x = fabs(x);
-	return -6 * pow(x, 5) + 15 * pow(x, 4) - 10 * pow(x, 3) + 1;
-}
+	int n = 0;
+	for (; n + 4 <= count; n += 4)
+	{
+		__m128 p[3];
+		__m128 f[3];
+		__m128 w[3][2];
+		__m128 one = _mm_set1_ps(1.0f);
+		alignas(16) int lattice[3][4];
+
+		p[0] = _mm_set_ps(points[n + 3].x, points[n + 2].x, points[n + 1].x, points[n].x);
+		p[1] = _mm_set_ps(points[n + 3].y, points[n + 2].y, points[n + 1].y, points[n].y);
+		p[2] = _mm_set_ps(points[n + 3].z, points[n + 2].z, points[n + 1].z, points[n].z);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// Floor without SSE4.1, truncation is one too large for negative non-integers.
+			__m128i truncated = _mm_cvttps_epi32(p[axis]);
+			__m128 tooLarge = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), p[axis]);
+			__m128i floored = _mm_add_epi32(truncated, _mm_castps_si128(tooLarge));
+			_mm_store_si128((__m128i*)lattice[axis], floored);
+
+			f[axis] = _mm_sub_ps(p[axis], _mm_cvtepi32_ps(floored));
+
+			// 1 - 10t^3 + 15t^4 - 6t^5 for both lattice points.
+			for (int d = 0; d < 2; d++)
+			{
+				__m128 t = (d == 0) ? f[axis] : _mm_sub_ps(one, f[axis]);
+				__m128 polynomial = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f)), t), _mm_set1_ps(10.0f));
+				w[axis][d] = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), polynomial));
+			}
+		}
+
+		__m128 noise = _mm_setzero_ps();
+		for (int corner = 0; corner < 8; corner++)
+		{
+			int dx = (corner >> 2) & 1;
+			int dy = (corner >> 1) & 1;
+			int dz = corner & 1;
+
+			// Gradient lookups are scalar, the table is too small to be worth a gather.
+			const Vec3f* e[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				e[lane] = &G[getGradientIndex(lattice[0][lane] + dx, lattice[1][lane] + dy, lattice[2][lane] + dz)];
+			}
+
+			__m128 vx = _mm_sub_ps(f[0], _mm_set1_ps((float)dx));
+			__m128 vy = _mm_sub_ps(f[1], _mm_set1_ps((float)dy));
+			__m128 vz = _mm_sub_ps(f[2], _mm_set1_ps((float)dz));
+			__m128 ex = _mm_set_ps(e[3]->x, e[2]->x, e[1]->x, e[0]->x);
+			__m128 ey = _mm_set_ps(e[3]->y, e[2]->y, e[1]->y, e[0]->y);
+			__m128 ez = _mm_set_ps(e[3]->z, e[2]->z, e[1]->z, e[0]->z);
+
+			__m128 dotProduct = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, vx), _mm_mul_ps(ey, vy)), _mm_mul_ps(ez, vz));
+			__m128 cornerWeight = _mm_mul_ps(_mm_mul_ps(w[0][dx], w[1][dy]), w[2][dz]);
+			noise = _mm_add_ps(noise, _mm_mul_ps(dotProduct, cornerWeight));
+		}
+
+		_mm_storeu_ps(noises + n, noise);
+	}
 
-float PerlinNoise::phi(int i) const
-{
-	i = i % 16;
-	if (i < 0)
+	// Remaining points one at a time.
+	for (; n < count; n++)
 	{
-		i += 16;
+		noises[n] = getNoiseValue(points[n]);
 	}
+}
+
+float PerlinNoise::weight(float x) const
+{
+	// 1 - 10x^3 + 15x^4 - 6x^5 in Horner form, x is in [0, 1].
+	return 1.0f - x * x * x * (x * (x * 6.0f - 15.0f) + 10.0f);
+}
 
-	return P[i];
+int PerlinNoise::phi(int i) const
+{
+	// Modulo 16 that stays positive for negative lattice coordinates.
+	return P[i & 15];
 }
 
-Vec3f PerlinNoise::getGradientVector(int i, int j, int k) const
+int PerlinNoise::getGradientIndex(int i, int j, int k) const
 {
-	int idx = phi(i + phi(j + phi(k)));
-	return G[idx];
+	return phi(i + phi(j + phi(k)));
 }
 
-PerlinTexture::PerlinTexture(const std::string& decalMode_, const std::string& noiseType_, float scalingFactor_, float bumpFactor_)
-	: Texture(decalMode_), scalingFactor(scalingFactor_), bumpFactor(bumpFactor_)
+PerlinTexture::PerlinTexture(const std::string& decalMode_, const std::string& noiseType_, float scalingFactor_, float bumpFactor_, unsigned int seed)
+	: Texture(decalMode_), scalingFactor(scalingFactor_), bumpFactor(bumpFactor_), perlinNoise(seed)
 {
 	noiseConversionType = parseNoiseConversionType(noiseType_);
-	perlinNoise = PerlinNoise();
 }
 
 Vec3f PerlinTexture::getTextureColor(const Vec2f& uv, const Vec3f& p) const
@@ -109,8 +175,30 @@ Vec3f PerlinTexture::getTextureColor(const Vec2f& uv, const Vec3f& p) const
 float PerlinTexture::getPerlinNoiseValue(const Vec3f& p) const
 {
 	Vec3f scaledPosition = p * scalingFactor;
-	float noise = perlinNoise.getNoiseValue(scaledPosition);
+	return convertNoise(perlinNoise.getNoiseValue(scaledPosition));
+}
+
+void PerlinTexture::getPerlinNoiseValues(const Vec3f* points, float* noises, int count) const
+{
+	Vec3f scaledPositions[4];
+	for (int n = 0; n < count; n += 4)
+	{
+		int batchSize = std::min(4, count - n);
+		for (int i = 0; i < batchSize; i++)
+		{
+			scaledPositions[i] = points[n + i] * scalingFactor;
+		}
+
+		perlinNoise.getNoiseValues(scaledPositions, noises + n, batchSize);
+		for (int i = 0; i < batchSize; i++)
+		{
+			noises[n + i] = convertNoise(noises[n + i]);
+		}
+	}
+}
 
+float PerlinTexture::convertNoise(float noise) const
+{
 	if (noiseConversionType == NOISECONVERSION_ABSVAL)
 	{
 		noise = abs(noise);
@@ -126,13 +214,16 @@ float PerlinTexture::getPerlinNoiseValue(const Vec3f& p) const
 Vec3f PerlinTexture::getBumpNormal(const Vec3f& p, const Vec3f& normal, const Matrix3f& tbn, const Vec2f& uv) const
 {
 	const float epsilon = 0.001;
-	float noise = getPerlinNoiseValue(p);
 
-	// Calculate gradient at p.
+	// Calculate gradient at p, the four noise values are evaluated together.
+	Vec3f points[4] = { p, Vec3f(p.x + epsilon, p.y, p.z), Vec3f(p.x, p.y + epsilon, p.z), Vec3f(p.x, p.y, p.z + epsilon) };
+	float noises[4];
+	getPerlinNoiseValues(points, noises, 4);
+
 	Vec3f g = Vec3f();
-	g.x = ((getPerlinNoiseValue(Vec3f(p.x + epsilon, p.y, p.z)) - noise) / epsilon) * bumpFactor;
-	g.y = ((getPerlinNoiseValue(Vec3f(p.x, p.y + epsilon, p.z)) - noise) / epsilon) * bumpFactor;
-	g.z = ((getPerlinNoiseValue(Vec3f(p.x, p.y, p.z + epsilon)) - noise) / epsilon) * bumpFactor;
+	g.x = ((noises[1] - noises[0]) / epsilon) * bumpFactor;
+	g.y = ((noises[2] - noises[0]) / epsilon) * bumpFactor;
+	g.z = ((noises[3] - noises[0]) / epsilon) * bumpFactor;
 
 	Vec3f gTangent = (g.dotProduct(normal)) * normal;
 	Vec3f gProjected = g - gTangent;
@@ -2,11 +2,7 @@
 #define PERLINTEXTURE_H_
 
 #include "Texture.h"
-#include "Vec3i.h"
 #include <string>
-#include <vector>
-#include <chrono>
-#include <random>
 
 enum NoiseConversionType
 {
@@ -14,27 +10,31 @@ enum NoiseConversionType
 	NOISECONVERSION_LINEAR
 };
 
+// Lattice noise with 16 gradient vectors, the permutation table is shuffled with the given seed.
+// Evaluation is allocation free, getNoiseValues evaluates four points at a time with SSE.
 class PerlinNoise
 {
 public:
-	PerlinNoise();
+	PerlinNoise(unsigned int seed);
 	float getNoiseValue(const Vec3f& p) const;
+	void getNoiseValues(const Vec3f* points, float* noises, int count) const;
 
 private:
 	Vec3f G[16];
-	std::vector<int> P;
+	int P[16];
 
 	float weight(float x) const;
-	float phi(int i) const;
-	Vec3f getGradientVector(int i, int j, int k) const;
+	int phi(int i) const;
+	int getGradientIndex(int i, int j, int k) const;
 };
 
 class PerlinTexture : public Texture
 {
 public:
-	PerlinTexture(const std::string& decalMode_, const std::string& noiseType_, float scalingFactor_, float bumpFactor_);
+	PerlinTexture(const std::string& decalMode_, const std::string& noiseType_, float scalingFactor_, float bumpFactor_, unsigned int seed);
 	Vec3f getTextureColor(const Vec2f& uv, const Vec3f& p) const;
 	float getPerlinNoiseValue(const Vec3f& p) const;
+	void getPerlinNoiseValues(const Vec3f* points, float* noises, int count) const;
 	Vec3f getNormalMapNormal(const Vec2f& uv, const Matrix3f& tbn) const { return Vec3f(); }
 	Vec3f getBumpNormal(const Vec3f& p, const Vec3f& normal, const Matrix3f& tbn, const Vec2f& uv) const;
 
@@ -44,6 +44,7 @@ private:
 	float bumpFactor;
 	PerlinNoise perlinNoise;
 
+	float convertNoise(float noise) const;
 	NoiseConversionType parseNoiseConversionType(const std::string& str);
 };
 
@@ -0,0 +1,487 @@
+#include "PlyLoader.h"
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char* mapFile(const std::string& path, size_t& size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	size = (size_t)fileSize.QuadPart;
+
+	// The view keeps the mapping alive, both handles can be closed right away.
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	const char* data = NULL;
+	if (mapping != NULL)
+	{
+		data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+	return data;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return NULL;
+	}
+
+	struct stat fileStatus;
+	fstat(file, &fileStatus);
+	size = (size_t)fileStatus.st_size;
+
+	void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return NULL;
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+	return (const char*)data;
+#endif
+}
+
+static void unmapFile(const char* data, size_t size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap((void*)data, size);
+#endif
+}
+
+static PlyType parseType(const std::string& name)
+{
+	if (name == "char" || name == "int8") return PLYTYPE_INT8;
+	if (name == "uchar" || name == "uint8") return PLYTYPE_UINT8;
+	if (name == "short" || name == "int16") return PLYTYPE_INT16;
+	if (name == "ushort" || name == "uint16") return PLYTYPE_UINT16;
+	if (name == "int" || name == "int32") return PLYTYPE_INT32;
+	if (name == "uint" || name == "uint32") return PLYTYPE_UINT32;
+	if (name == "float" || name == "float32") return PLYTYPE_FLOAT32;
+	if (name == "double" || name == "float64") return PLYTYPE_FLOAT64;
+
+	throw std::runtime_error("Error: Unknown PLY property type " + name + ".");
+}
+
+static int getTypeSize(PlyType type)
+{
+	switch (type)
+	{
+	case PLYTYPE_INT8:
+	case PLYTYPE_UINT8:
+		return 1;
+	case PLYTYPE_INT16:
+	case PLYTYPE_UINT16:
+		return 2;
+	case PLYTYPE_FLOAT64:
+		return 8;
+	default:
+		return 4;
+	}
+}
+
+template <typename T>
+static double decodeValue(const unsigned char* bytes)
+{
+	T value;
+	memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+PlyLoader::PlyLoader(const std::string& path_)
+	: numberOfVertices(0), numberOfFaces(0), hasTextureCoordinates(false), path(path_), format(PLYFORMAT_ASCII),
+	currentElement(0), remainingFaces(-1), faceIndexProperty(-1), mappedFile(NULL), mappedSize(0), cursor(NULL), end(NULL), linePosition(NULL)
+{
+	stream.open(path, std::ios::binary);
+	if (!stream)
+	{
+		throw std::runtime_error("Error: " + path + " cannot be opened.");
+	}
+
+	parseHeader();
+
+	for (size_t i = 0; i < elements.size(); i++)
+	{
+		const PlyElement& element = elements[i];
+		if (element.name == "vertex")
+		{
+			numberOfVertices = element.count;
+			bool hasU = false;
+			bool hasV = false;
+			for (size_t p = 0; p < element.properties.size(); p++)
+			{
+				hasU = hasU || element.properties[p].name == "u";
+				hasV = hasV || element.properties[p].name == "v";
+			}
+			hasTextureCoordinates = hasU && hasV;
+		}
+		else if (element.name == "face")
+		{
+			numberOfFaces = element.count;
+			int numberOfProperties = (int)element.properties.size();
+			for (int p = 0; p < numberOfProperties; p++)
+			{
+				const PlyProperty& property = element.properties[p];
+				if (property.isList == true && (property.name == "vertex_indices" || property.name == "vertex_index"))
+				{
+					faceIndexProperty = p;
+				}
+			}
+			if (faceIndexProperty < 0)
+			{
+				throw std::runtime_error("Error: " + path + " has no vertex indices in its faces.");
+			}
+		}
+	}
+
+	if (format == PLYFORMAT_ASCII)
+	{
+		line.clear();
+		linePosition = line.c_str();
+	}
+	else
+	{
+		// The data after the header is decoded directly from the mapped file.
+		size_t headerSize = (size_t)stream.tellg();
+		stream.close();
+
+		mappedFile = mapFile(path, mappedSize);
+		if (mappedFile == NULL)
+		{
+			throw std::runtime_error("Error: " + path + " cannot be mapped.");
+		}
+		cursor = mappedFile + headerSize;
+		end = mappedFile + mappedSize;
+	}
+}
+
+PlyLoader::~PlyLoader()
+{
+	if (mappedFile != NULL)
+	{
+		unmapFile(mappedFile, mappedSize);
+	}
+}
+
+void PlyLoader::parseHeader()
+{
+	std::getline(stream, line);
+	if (line.compare(0, 3, "ply") != 0)
+	{
+		throw std::runtime_error("Error: " + path + " is not a PLY file.");
+	}
+
+	while (std::getline(stream, line))
+	{
+		std::istringstream lineStream(line);
+		std::string keyword;
+		lineStream >> keyword;
+
+		if (keyword == "format")
+		{
+			std::string name;
+			lineStream >> name;
+			if (name == "ascii")
+			{
+				format = PLYFORMAT_ASCII;
+			}
+			else if (name == "binary_little_endian")
+			{
+				format = PLYFORMAT_BINARY_LITTLE_ENDIAN;
+			}
+			else if (name == "binary_big_endian")
+			{
+				format = PLYFORMAT_BINARY_BIG_ENDIAN;
+			}
+			else
+			{
+				throw std::runtime_error("Error: Unknown PLY format " + name + ".");
+			}
+		}
+		else if (keyword == "element")
+		{
+			PlyElement element;
+			lineStream >> element.name >> element.count;
+			elements.push_back(element);
+		}
+		else if (keyword == "property")
+		{
+			if (elements.empty())
+			{
+				throw std::runtime_error("Error: " + path + " has a property outside of an element.");
+			}
+
+			PlyProperty property;
+			std::string type;
+			lineStream >> type;
+			if (type == "list")
+			{
+				std::string countType;
+				std::string itemType;
+				lineStream >> countType >> itemType;
+				property.isList = true;
+				property.countType = parseType(countType);
+				property.type = parseType(itemType);
+			}
+			else
+			{
+				property.isList = false;
+				property.type = parseType(type);
+				property.countType = property.type;
+			}
+			lineStream >> property.name;
+			elements.back().properties.push_back(property);
+		}
+		else if (keyword == "end_header")
+		{
+			return;
+		}
+		// Comments and obj_info lines are skipped.
+	}
+
+	throw std::runtime_error("Error: " + path + " has no end of header.");
+}
+
+void PlyLoader::readVertices(Vec3f* positions, Vec2f* textureCoordinates)
+{
+	skipToElement("vertex");
+	const PlyElement& element = elements[currentElement];
+
+	int x = -1, y = -1, z = -1, u = -1, v = -1;
+	bool isFloatRecord = true;	// only float scalars, so the record has a fixed layout
+	int numberOfProperties = (int)element.properties.size();
+	for (int p = 0; p < numberOfProperties; p++)
+	{
+		const PlyProperty& property = element.properties[p];
+		if (property.name == "x") x = p;
+		else if (property.name == "y") y = p;
+		else if (property.name == "z") z = p;
+		else if (property.name == "u") u = p;
+		else if (property.name == "v") v = p;
+		isFloatRecord = isFloatRecord && property.isList == false && property.type == PLYTYPE_FLOAT32;
+	}
+	if (x < 0 || y < 0 || z < 0)
+	{
+		throw std::runtime_error("Error: " + path + " has no vertex positions.");
+	}
+	if (hasTextureCoordinates == false)
+	{
+		textureCoordinates = NULL;
+	}
+
+	if (format == PLYFORMAT_BINARY_LITTLE_ENDIAN && isFloatRecord == true && element.properties.size() <= 256)
+	{
+		// Common case, the floats are copied out of the mapped file without conversion.
+		size_t stride = element.properties.size() * sizeof(float);
+		if ((size_t)(end - cursor) < stride * element.count)
+		{
+			throw std::runtime_error("Error: " + path + " is truncated.");
+		}
+
+		for (int i = 0; i < element.count; i++)
+		{
+			float record[256];
+			memcpy(record, cursor, stride);
+			cursor += stride;
+
+			positions[i] = Vec3f(record[x], record[y], record[z]);
+			if (textureCoordinates != NULL)
+			{
+				textureCoordinates[i] = Vec2f(record[u], record[v]);
+			}
+		}
+	}
+	else
+	{
+		std::vector<double> values(element.properties.size());
+		for (int i = 0; i < element.count; i++)
+		{
+			readRecord(element, values.data());
+
+			positions[i] = Vec3f(values[x], values[y], values[z]);
+			if (textureCoordinates != NULL)
+			{
+				textureCoordinates[i] = Vec2f(values[u], values[v]);
+			}
+		}
+	}
+
+	currentElement++;
+}
+
+int PlyLoader::readFace(int* indices, int capacity)
+{
+	if (remainingFaces < 0)
+	{
+		skipToElement("face");
+		remainingFaces = elements[currentElement].count;
+	}
+	if (remainingFaces == 0)
+	{
+		throw std::runtime_error("Error: " + path + " has no more faces.");
+	}
+	remainingFaces--;
+
+	const PlyElement& element = elements[currentElement];
+	int numberOfIndices = 0;
+	int numberOfProperties = (int)element.properties.size();
+	for (int p = 0; p < numberOfProperties; p++)
+	{
+		const PlyProperty& property = element.properties[p];
+		if (property.isList == false)
+		{
+			readValue(property.type);
+			continue;
+		}
+
+		int count = (int)readValue(property.countType);
+		for (int k = 0; k < count; k++)
+		{
+			double index = readValue(property.type);
+			if (p != faceIndexProperty)
+			{
+				continue;
+			}
+
+			// Indices go straight into the vertex buffers of the scene, a bad one must not reach them.
+			if (index < 0.0 || index >= numberOfVertices)
+			{
+				throw std::runtime_error("Error: " + path + " has a face with a vertex index out of range.");
+			}
+			if (k < capacity)
+			{
+				indices[k] = (int)index;
+			}
+		}
+		if (p == faceIndexProperty)
+		{
+			numberOfIndices = count;
+		}
+	}
+
+	return numberOfIndices;
+}
+
+void PlyLoader::skipToElement(const std::string& name)
+{
+	while (currentElement < elements.size() && elements[currentElement].name != name)
+	{
+		const PlyElement& element = elements[currentElement];
+		std::vector<double> values(element.properties.size());
+		for (int i = 0; i < element.count; i++)
+		{
+			readRecord(element, values.data());
+		}
+		currentElement++;
+	}
+
+	if (currentElement == elements.size())
+	{
+		throw std::runtime_error("Error: " + path + " has no " + name + " element at the expected position.");
+	}
+}
+
+void PlyLoader::readRecord(const PlyElement& element, double* values)
+{
+	// Lists other than the face indices carry nothing the scene uses, only their length is kept.
+	for (size_t p = 0; p < element.properties.size(); p++)
+	{
+		const PlyProperty& property = element.properties[p];
+		if (property.isList == true)
+		{
+			int count = (int)readValue(property.countType);
+			for (int k = 0; k < count; k++)
+			{
+				readValue(property.type);
+			}
+			values[p] = count;
+		}
+		else
+		{
+			values[p] = readValue(property.type);
+		}
+	}
+}
+
+double PlyLoader::readValue(PlyType type)
+{
+	if (format == PLYFORMAT_ASCII)
+	{
+		return readAsciiValue(type);
+	}
+
+	int size = getTypeSize(type);
+	if (end - cursor < size)
+	{
+		throw std::runtime_error("Error: " + path + " is truncated.");
+	}
+
+	unsigned char bytes[8];
+	memcpy(bytes, cursor, size);
+	cursor += size;
+
+	// The renderer runs on little endian machines.
+	if (format == PLYFORMAT_BINARY_BIG_ENDIAN)
+	{
+		std::reverse(bytes, bytes + size);
+	}
+
+	switch (type)
+	{
+	case PLYTYPE_INT8:
+		return decodeValue<int8_t>(bytes);
+	case PLYTYPE_UINT8:
+		return decodeValue<uint8_t>(bytes);
+	case PLYTYPE_INT16:
+		return decodeValue<int16_t>(bytes);
+	case PLYTYPE_UINT16:
+		return decodeValue<uint16_t>(bytes);
+	case PLYTYPE_INT32:
+		return decodeValue<int32_t>(bytes);
+	case PLYTYPE_UINT32:
+		return decodeValue<uint32_t>(bytes);
+	case PLYTYPE_FLOAT32:
+		return decodeValue<float>(bytes);
+	default:
+		return decodeValue<double>(bytes);
+	}
+}
+
+double PlyLoader::readAsciiValue(PlyType type)
+{
+	// Values are separated by any whitespace, a record may continue on the next line.
+	char* next;
+	double value = (type == PLYTYPE_FLOAT32) ? strtof(linePosition, &next) : strtod(linePosition, &next);
+	while (next == linePosition)
+	{
+		if (!std::getline(stream, line))
+		{
+			throw std::runtime_error("Error: " + path + " is truncated.");
+		}
+		linePosition = line.c_str();
+		value = (type == PLYTYPE_FLOAT32) ? strtof(linePosition, &next) : strtod(linePosition, &next);
+	}
+	linePosition = next;
+	return value;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef PLYLOADER_H_
+#define PLYLOADER_H_
+
+#include "Vec2f.h"
+#include "Vec3f.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+enum PlyFormat
+{
+	PLYFORMAT_ASCII,
+	PLYFORMAT_BINARY_LITTLE_ENDIAN,
+	PLYFORMAT_BINARY_BIG_ENDIAN
+};
+
+enum PlyType
+{
+	PLYTYPE_INT8,
+	PLYTYPE_UINT8,
+	PLYTYPE_INT16,
+	PLYTYPE_UINT16,
+	PLYTYPE_INT32,
+	PLYTYPE_UINT32,
+	PLYTYPE_FLOAT32,
+	PLYTYPE_FLOAT64
+};
+
+struct PlyProperty
+{
+	std::string name;
+	PlyType type;		// type of the list items for list properties
+	bool isList;
+	PlyType countType;	// type of the list length
+};
+
+struct PlyElement
+{
+	std::string name;
+	int count;
+	std::vector<PlyProperty> properties;
+};
+
+// Reads the vertices and the faces of a PLY file straight into the buffers of the scene.
+// Binary files are memory mapped and decoded in place, ASCII files are streamed line by line,
+// so no intermediate copy of the mesh is built. The vertices have to be read before the faces.
+class PlyLoader
+{
+public:
+	int numberOfVertices;
+	int numberOfFaces;
+	bool hasTextureCoordinates;
+
+	PlyLoader(const std::string& path_);
+	~PlyLoader();
+	void readVertices(Vec3f* positions, Vec2f* textureCoordinates);	// textureCoordinates may be NULL
+	int readFace(int* indices, int capacity);	// number of vertices of the next face, at most capacity indices are stored
+
+private:
+	std::string path;
+	PlyFormat format;
+	std::vector<PlyElement> elements;
+	size_t currentElement;	// element the data is read from
+	int remainingFaces;	// -1 before the face element is reached
+	int faceIndexProperty;
+
+	// Binary files
+	const char* mappedFile;
+	size_t mappedSize;
+	const char* cursor;
+	const char* end;
+
+	// ASCII files
+	std::ifstream stream;
+	std::string line;
+	const char* linePosition;
+
+	void parseHeader();
+	void skipToElement(const std::string& name);
+	void readRecord(const PlyElement& element, double* values);
+	double readValue(PlyType type);
+	double readAsciiValue(PlyType type);
+
+	PlyLoader(const PlyLoader&) = delete;
+	PlyLoader& operator=(const PlyLoader&) = delete;
+};
+
+#endif
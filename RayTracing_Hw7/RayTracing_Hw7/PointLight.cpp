@@ -1,21 +1,25 @@
 #include "Light.h"
+#include "LightBVH.h"
 
-Vec3f PointLight::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample PointLight::sample(const Vec3f& intersectionPoint, const Vec3f&, const Vec2f&) const
 {
-	Vec3f wi = (position - intersectionPoint).unitVector();
-	return wi;
-}
+	LightSample lightSample;
+	Vec3f l = position - intersectionPoint;
+	lightSample.distance = l.length();
+	lightSample.wi = l / lightSample.distance;
+	lightSample.radiance = intensity / (lightSample.distance * lightSample.distance);
+	lightSample.pdf = 1.0f;
 
-float PointLight::calculateDistance(const Vec3f& intersectionPoint)
-{
-	float dist = (position - intersectionPoint).length();
-	return dist;
+	return lightSample;
 }
 
-Vec3f PointLight::calculateIrradiance(const Vec3f& intersectionPoint)
+bool PointLight::getLightBounds(LightBounds& lightBounds) const
 {
-	float lightDistance = calculateDistance(intersectionPoint);
-	Vec3f irradiance = intensity / (lightDistance * lightDistance);
-
-	return irradiance;
+	// Emits in all directions from a single point.
+	lightBounds.bounds = BoundingBox(position, position);
+	lightBounds.axis = Vec3f(0.0f, 0.0f, 1.0f);
+	lightBounds.cosThetaO = -1.0f;
+	lightBounds.cosThetaE = 0.0f;
+	lightBounds.power = 4.0f * PI * intensity.getAvg();
+	return true;
 }
\ No newline at end of file
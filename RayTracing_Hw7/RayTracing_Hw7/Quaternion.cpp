@@ -0,0 +1,71 @@
+#include "Quaternion.h"
+#include <cmath>
+
+Quaternion Quaternion::operator+(const Quaternion& rhs) const
+{
+	return Quaternion(w + rhs.w, v + rhs.v);
+}
+
+Quaternion Quaternion::operator*(float rhs) const
+{
+	return Quaternion(w * rhs, v * rhs);
+}
+
+float Quaternion::dotProduct(const Quaternion& rhs) const
+{
+	return w * rhs.w + v.dotProduct(rhs.v);
+}
+
+Quaternion Quaternion::unitQuaternion() const
+{
+	float length = sqrt(dotProduct(*this));
+	return Quaternion(w / length, v / length);
+}
+
+Vec3f Quaternion::rotate(const Vec3f& vector) const
+{
+	// v' = vector + 2w (v x vector) + 2 v x (v x vector)
+	Vec3f t = 2.0f * v.crossProduct(vector);
+	return vector + w * t + v.crossProduct(t);
+}
+
+Vec3f Quaternion::inverseRotate(const Vec3f& vector) const
+{
+	// Rotate with the conjugate.
+	Vec3f t = 2.0f * v.crossProduct(vector);
+	return vector - w * t + v.crossProduct(t);
+}
+
+float Quaternion::getAngle(const Quaternion& rhs) const
+{
+	float cosHalfAngle = std::min(1.0f, std::abs(dotProduct(rhs)));
+	return 2.0f * acos(cosHalfAngle);
+}
+
+Quaternion Quaternion::fromAxisAngle(float angleRad, const Vec3f& axis)
+{
+	Vec3f n = Vec3f(axis).unitVector();
+	return Quaternion(cos(angleRad / 2.0f), n * sin(angleRad / 2.0f));
+}
+
+Quaternion Quaternion::slerp(const Quaternion& q0, const Quaternion& q1, float t)
+{
+	// q and -q are the same rotation, take the shorter arc.
+	Quaternion q2 = q1;
+	float cosTheta = q0.dotProduct(q1);
+	if (cosTheta < 0.0f)
+	{
+		q2 = q1 * -1.0f;
+		cosTheta = -cosTheta;
+	}
+
+	// Nearly parallel quaternions, linear interpolation avoids dividing by sin(theta).
+	if (cosTheta > 0.9995f)
+	{
+		return (q0 * (1.0f - t) + q2 * t).unitQuaternion();
+	}
+
+	float theta = acos(cosTheta);
+	float sinTheta = sin(theta);
+	return (q0 * (sin((1.0f - t) * theta) / sinTheta) + q2 * (sin(t * theta) / sinTheta)).unitQuaternion();
+}
\ No newline at end of file
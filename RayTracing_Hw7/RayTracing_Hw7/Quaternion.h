@@ -0,0 +1,27 @@
+#ifndef QUATERNION_H_
+#define QUATERNION_H_
+
+#include "Vec3f.h"
+
+// Unit quaternion representing a rotation, w is the scalar part and v the vector part.
+class Quaternion
+{
+public:
+	float w;
+	Vec3f v;
+
+	Quaternion() : w(1.0f), v(0.0f, 0.0f, 0.0f) {}
+	Quaternion(float w_, const Vec3f& v_) : w(w_), v(v_) {}
+
+	Quaternion operator+(const Quaternion& rhs) const;
+	Quaternion operator*(float rhs) const;
+	float dotProduct(const Quaternion& rhs) const;
+	Quaternion unitQuaternion() const;
+	Vec3f rotate(const Vec3f& vector) const;
+	Vec3f inverseRotate(const Vec3f& vector) const;
+	float getAngle(const Quaternion& rhs) const;		// rotation angle between two orientations
+	static Quaternion fromAxisAngle(float angleRad, const Vec3f& axis);
+	static Quaternion slerp(const Quaternion& q0, const Quaternion& q1, float t);
+};
+
+#endif
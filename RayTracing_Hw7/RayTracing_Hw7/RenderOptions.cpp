@@ -0,0 +1,173 @@
+#include "RenderOptions.h"
+#include "FramePipeline.h"
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+static const char* getArgument(int argc, char* argv[], int& i)
+{
+	if (i + 1 >= argc)
+	{
+		throw std::runtime_error(std::string("Error: Missing value for ") + argv[i] + ".");
+	}
+
+	i++;
+	return argv[i];
+}
+
+static int getIntArgument(int argc, char* argv[], int& i)
+{
+	const char* option = argv[i];
+	const char* value = getArgument(argc, argv, i);
+
+	char* end;
+	long result = strtol(value, &end, 10);
+	if (*value == '\0' || *end != '\0')
+	{
+		throw std::runtime_error(std::string("Error: Invalid value for ") + option + ": " + value);
+	}
+
+	return result;
+}
+
+static float getFloatArgument(int argc, char* argv[], int& i)
+{
+	const char* option = argv[i];
+	const char* value = getArgument(argc, argv, i);
+
+	char* end;
+	float result = strtof(value, &end);
+	if (*value == '\0' || *end != '\0')
+	{
+		throw std::runtime_error(std::string("Error: Invalid value for ") + option + ": " + value);
+	}
+
+	return result;
+}
+
+int RenderOptions::getNumberOfThreads() const
+{
+	if (numberOfThreads > 0)
+	{
+		return numberOfThreads;
+	}
+
+	int hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0)
+	{
+		hardwareThreads = 8;
+	}
+
+	return hardwareThreads;
+}
+
+void RenderOptions::parseArguments(int argc, char* argv[], std::vector<std::string>& scenePaths)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+
+		if (strcmp(arg, "--threads") == 0)
+		{
+			numberOfThreads = getIntArgument(argc, argv, i);
+			if (numberOfThreads < 1)
+			{
+				throw std::runtime_error("Error: Thread count must be positive.");
+			}
+		}
+		else if (strcmp(arg, "--samples") == 0)
+		{
+			// Samples are taken on a jittered grid, so the sample count has to be a square number.
+			numberOfSamples = getIntArgument(argc, argv, i);
+			int gridSize = (int)(sqrt((float)numberOfSamples) + 0.5f);
+			if (numberOfSamples < 1 || gridSize * gridSize != numberOfSamples)
+			{
+				throw std::runtime_error("Error: Sample count must be a positive square number.");
+			}
+		}
+		else if (strcmp(arg, "--scale") == 0)
+		{
+			resolutionScale = getFloatArgument(argc, argv, i);
+			if (resolutionScale <= 0.0f)
+			{
+				throw std::runtime_error("Error: Resolution scale must be positive.");
+			}
+		}
+		else if (strcmp(arg, "--crop") == 0)
+		{
+			crop = true;
+			cropMinX = getFloatArgument(argc, argv, i);
+			cropMaxX = getFloatArgument(argc, argv, i);
+			cropMinY = getFloatArgument(argc, argv, i);
+			cropMaxY = getFloatArgument(argc, argv, i);
+			if (cropMinX < 0.0f || cropMaxX > 1.0f || cropMinX >= cropMaxX || cropMinY < 0.0f || cropMaxY > 1.0f || cropMinY >= cropMaxY)
+			{
+				throw std::runtime_error("Error: Crop window must be inside [0, 1] and not empty.");
+			}
+		}
+		else if (strcmp(arg, "--output-dir") == 0)
+		{
+			outputDirectory = getArgument(argc, argv, i);
+		}
+		else if (strcmp(arg, "--seed") == 0)
+		{
+			fixedSeed = true;
+			seed = getIntArgument(argc, argv, i);
+		}
+		else if (strcmp(arg, "--stats") == 0)
+		{
+			printStatistics = true;
+		}
+		else if (strcmp(arg, "--light-tree") == 0)
+		{
+			lightTree = true;
+		}
+		else if (strcmp(arg, "--resume") == 0)
+		{
+			// Continue the renders from their last checkpoints.
+			resumeFromCheckpoint = true;
+		}
+		else if (strcmp(arg, "--checkpoint-interval") == 0)
+		{
+			checkpointInterval = getIntArgument(argc, argv, i);
+		}
+		else if (strcmp(arg, "--frames") == 0)
+		{
+			// Animation sequence: --frames water_animation/smooth/tap_%04d.xml 243 285
+			std::string pattern = getArgument(argc, argv, i);
+			int firstFrame = getIntArgument(argc, argv, i);
+			int lastFrame = getIntArgument(argc, argv, i);
+
+			std::vector<std::string> framePaths = FramePipeline::expandFramePattern(pattern, firstFrame, lastFrame);
+			scenePaths.insert(scenePaths.end(), framePaths.begin(), framePaths.end());
+		}
+		else if (arg[0] == '-' && arg[1] == '-')
+		{
+			throw std::runtime_error(std::string("Error: Unknown option ") + arg);
+		}
+		else
+		{
+			scenePaths.push_back(arg);
+		}
+	}
+}
+
+void RenderOptions::printUsage(const char* program)
+{
+	std::cout << "Usage: " << program << " [options] scene.xml [scene.xml ...]" << std::endl;
+	std::cout << "Options:" << std::endl;
+	std::cout << "  --threads <n>                  number of worker threads" << std::endl;
+	std::cout << "  --samples <n>                  samples per pixel of every camera (square number)" << std::endl;
+	std::cout << "  --scale <f>                    image resolution multiplier" << std::endl;
+	std::cout << "  --crop <x0> <x1> <y0> <y1>     render only the given window of the images, in [0, 1]" << std::endl;
+	std::cout << "  --output-dir <dir>             directory of the rendered images" << std::endl;
+	std::cout << "  --seed <n>                     fixed random seed" << std::endl;
+	std::cout << "  --stats                        print ray counts and render time" << std::endl;
+	std::cout << "  --light-tree                   shade with one light from the light hierarchy instead of all lights" << std::endl;
+	std::cout << "  --resume                       continue from the last checkpoints" << std::endl;
+	std::cout << "  --checkpoint-interval <secs>   time between checkpoints, 0 disables checkpointing" << std::endl;
+	std::cout << "  --frames <pattern> <first> <last>  render an animation, e.g. tap_%04d.xml 243 285" << std::endl;
+}
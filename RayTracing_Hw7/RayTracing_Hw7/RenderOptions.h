@@ -0,0 +1,34 @@
+#ifndef RENDEROPTIONS_H_
+#define RENDEROPTIONS_H_
+
+#include <string>
+#include <vector>
+
+// Settings that override the scene file, mostly given from the command line.
+class RenderOptions
+{
+public:
+	int numberOfThreads;		// worker threads, hardware concurrency if zero
+	int numberOfSamples;		// samples per pixel of every camera, taken from the scene file if zero
+	float resolutionScale;		// image resolution multiplier
+	bool crop;
+	float cropMinX, cropMaxX, cropMinY, cropMaxY;	// rendered window in [0, 1] image coordinates, y points down
+	std::string outputDirectory;	// images are written next to the executable if empty
+	bool fixedSeed;
+	unsigned int seed;			// random seed of the samplers if fixedSeed is set
+	bool printStatistics;
+	bool lightTree;				// sample one light from the light BVH per shading point in every camera
+
+	// Checkpointing
+	bool resumeFromCheckpoint;	// continue from the last checkpoint of each camera if one exists
+	int checkpointInterval;		// in seconds, checkpointing is disabled if zero
+
+	RenderOptions()
+		: numberOfThreads(0), numberOfSamples(0), resolutionScale(1.0f), crop(false), cropMinX(0.0f), cropMaxX(1.0f), cropMinY(0.0f), cropMaxY(1.0f),
+		fixedSeed(false), seed(0), printStatistics(false), lightTree(false), resumeFromCheckpoint(false), checkpointInterval(300) {}
+	int getNumberOfThreads() const;
+	void parseArguments(int argc, char* argv[], std::vector<std::string>& scenePaths);
+	static void printUsage(const char* program);
+};
+
+#endif
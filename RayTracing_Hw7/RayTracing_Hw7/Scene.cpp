@@ -1,170 +1,362 @@
 #include "Scene.h"
 #include "Utils.h"
 #include <thread>
+#include <cstdio>
+
+// Width and height of the image regions that are rendered as a single task.
+static const int tileSize = 32;
+
+thread_local std::default_random_engine Scene::randGenerator;
+thread_local std::uniform_real_distribution<float> Scene::distribution(0.0f, 1.0f);
+
+static std::string getCheckpointName(const Camera& camera)
+{
+	return camera.imageName + ".checkpoint";
+}
+
+Scene::Scene()
+	: bvh(NULL), backgroundTexture(NULL), sphericalDirLight(NULL), lightBVH(NULL), deferImageWriting(false), samplerSeed(0)
+{
+}
 
 void Scene::renderScene()
 {
-	// Initialize uniform random number distribution.
-	randGenerator.seed(std::chrono::system_clock::now().time_since_epoch().count());
-	distribution = std::uniform_real_distribution<float>(0.0f, 1.0f);
+	ThreadPool threadPool(options.getNumberOfThreads());
+	renderScene(threadPool);
+}
+
+void Scene::renderScene(ThreadPool& threadPool)
+{
+	// Base seed of the tile samplers.
+	if (options.fixedSeed == true)
+	{
+		samplerSeed = options.seed;
+	}
+	else
+	{
+		samplerSeed = (unsigned int)std::chrono::system_clock::now().time_since_epoch().count();
+	}
 
-	int numberOfThreads = 8;
 	int numberOfCameras = cameras.size();
+	std::vector<CameraRender*> cameraRenders;
+	images = std::vector<Image>(numberOfCameras);
+
+	for (int i = 0; i < numberOfCameras; i++)
+	{
+		// Camera parameters and materials are computed once, tile tasks read the camera by reference.
+		cameras[i].setCameraParams();
+		setCameraMaterials(cameras[i]);
+		const Camera& camera = cameras[i];
+
+		CameraRender* render = new CameraRender();
+		render->cameraIdx = i;
+		render->pixelColors = std::vector<Vec3f>(camera.imageWidth * camera.imageHeight, Vec3f());
+		render->numberOfPasses = getNumberOfPasses(camera);
+		render->currentPass = 0;
+		render->samplerSeed = samplerSeed;
+		render->checkpointName = getCheckpointName(camera);
+		render->start = std::chrono::system_clock::now();
+		render->lastCheckpoint = render->start;
+
+		if (options.resumeFromCheckpoint == true)
+		{
+			resumeCamera(camera, render);
+		}
+
+		cameraRenders.push_back(render);
+	}
+
+	// Tiles of all cameras share the same task queue, so cameras overlap and threads do not wait between them.
+	for (int i = 0; i < numberOfCameras; i++)
+	{
+		addTileTasks(threadPool, cameraRenders[i]);
+	}
+
+	threadPool.waitForTasks();
 
 	for (int i = 0; i < numberOfCameras; i++)
 	{
-		Camera currentCamera = cameras[i];
-		int width = currentCamera.imageWidth;
-		int height = currentCamera.imageHeight;
+		delete cameraRenders[i];
+	}
+}
 
-		auto start = std::chrono::system_clock::now();
-		std::vector<Vec3f> pixelColors(width * height, Vec3f());
+void Scene::addTileTasks(ThreadPool& threadPool, CameraRender* render)
+{
+	const Camera& camera = cameras[render->cameraIdx];
+	int width = camera.imageWidth;
+	int height = camera.imageHeight;
+	int tilesX = (width + tileSize - 1) / tileSize;
+	int tilesY = (height + tileSize - 1) / tileSize;
 
-		int stepSize = height / numberOfThreads;
-		std::vector<std::thread> threads;
-		for (int k = 0; k < numberOfThreads; k++)
+	render->remainingTiles = tilesX * tilesY;
+	int pass = render->currentPass;
+
+	for (int ty = 0; ty < tilesY; ty++)
+	{
+		for (int tx = 0; tx < tilesX; tx++)
 		{
-			int minHeight = k * stepSize;
-			int maxHeight = minHeight + stepSize;
+			int minX = tx * tileSize;
+			int minY = ty * tileSize;
+			int maxX = std::min(minX + tileSize, width);
+			int maxY = std::min(minY + tileSize, height);
+
+			int tileIdx = ty * tilesX + tx;
+			threadPool.addTask([this, &threadPool, render, minX, maxX, minY, maxY, pass, tileIdx]()
+			{
+				seedTileSampler(render, pass, tileIdx);
+				renderTile(cameras[render->cameraIdx], minX, maxX, minY, maxY, pass, render->pixelColors);
+				Statistics::flush();
 
-			threads.push_back(std::thread(&Scene::renderScenePartial, this, minHeight, maxHeight, i, std::ref(pixelColors)));
+				// The thread that renders the last tile of the pass continues with the next pass.
+				if (--render->remainingTiles == 0)
+				{
+					finishPass(threadPool, render);
+				}
+			});
 		}
+	}
+}
+
+void Scene::seedTileSampler(const CameraRender* render, int pass, int tileIdx)
+{
+	// Every tile draws its own sample sequence, so the image does not depend on which thread renders which tile.
+	std::seed_seq seedSequence = { render->samplerSeed, (unsigned int)render->cameraIdx, (unsigned int)pass, (unsigned int)tileIdx };
+	randGenerator.seed(seedSequence);
+	distribution.reset();
+}
+
+void Scene::finishPass(ThreadPool& threadPool, CameraRender* render)
+{
+	render->currentPass++;
+	if (render->currentPass == render->numberOfPasses)
+	{
+		finishCamera(render);
+		return;
+	}
+
+	// No tile of this camera is being rendered now, so the accumulated samples are consistent.
+	auto now = std::chrono::system_clock::now();
+	if (options.checkpointInterval > 0 && now - render->lastCheckpoint >= std::chrono::seconds(options.checkpointInterval))
+	{
+		writeCheckpoint(cameras[render->cameraIdx], render);
+		render->lastCheckpoint = now;
+	}
 
-		for (int i = 0; i < numberOfThreads; i++)
+	addTileTasks(threadPool, render);
+}
+
+void Scene::finishCamera(CameraRender* render)
+{
+	const Camera& camera = cameras[render->cameraIdx];
+	std::vector<Vec3f>& pixelColors = render->pixelColors;
+
+	if (camera.numberOfSamples > 1)
+	{
+		// Box Filtering
+		for (size_t k = 0; k < pixelColors.size(); k++)
 		{
-			threads[i].join();
+			pixelColors[k] = pixelColors[k] / camera.numberOfSamples;
 		}
+	}
 
-		auto end = std::chrono::system_clock::now();
-		printTimeDuration(currentCamera.imageName, start, end);
+	auto end = std::chrono::system_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(outputMutex);
+		printTimeDuration(camera.imageName, render->start, end);
+	}
 
-		Image image = Image(width, height, pixelColors);
-		image.writeImage(currentCamera.imageName, currentCamera.tonemap);
+	Image image = Image(camera.imageWidth, camera.imageHeight, pixelColors);
+	if (deferImageWriting == true)
+	{
+		images[render->cameraIdx] = image;
+		return;
 	}
+
+	image.writeImage(camera.imageName, camera.tonemap);
+
+	// Image is complete, checkpoint is not needed anymore.
+	std::remove(render->checkpointName.c_str());
 }
 
-void Scene::renderScenePartial(int minHeight, int maxHeight, int cameraIdx, std::vector<Vec3f>& pixelColors)
+void Scene::writeImages() const
 {
-	Camera camera = cameras[cameraIdx];
-	camera.setCameraParams();
+	// Tonemap and encode the images kept by a render with deferred image writing.
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		images[i].writeImage(cameras[i].imageName, cameras[i].tonemap);
 
+		std::string checkpointName = getCheckpointName(cameras[i]);
+		std::remove(checkpointName.c_str());
+	}
+}
+
+void Scene::renderTile(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, std::vector<Vec3f>& pixelColors)
+{
 	int width = camera.imageWidth;
-	int rgbIdx = minHeight * width;
+
+	if (camera.renderingMode == RENDERINGMODE_PATHTRACING && camera.wavefront == true)
+	{
+		renderTileWavefront(camera, minX, maxX, minY, maxY, pass, pixelColors);
+		return;
+	}
 
 	if (camera.numberOfSamples == 1)
 	{
-		for (int i = minHeight; i < maxHeight; i++)
+		for (int i = minY; i < maxY; i++)
 		{
-			for (int j = 0; j < width; j++)
+			for (int j = minX; j < maxX; j++)
 			{
 				Vec3f color = renderPixel(camera, j, i);
-				pixelColors[rgbIdx++] = color;
+				pixelColors[i * width + j] = color;
 			}
 		}
 	}
 	else
 	{
-		// Ray tracing with multisampling
-		for (int i = minHeight; i < maxHeight; i++)
+		// Ray tracing with multisampling, accumulate the samples of this pass.
+		for (int i = minY; i < maxY; i++)
 		{
-			for (int j = 0; j < width; j++)
+			for (int j = minX; j < maxX; j++)
 			{
-				Vec3f color = renderPixelMultisampling(camera, j, i);
-				pixelColors[rgbIdx++] = color;
+				Vec3f color = renderPixelMultisampling(camera, j, i, pass);
+				pixelColors[i * width + j] += color;
 			}
 		}
-	}	
+	}
 }
 
-Vec3f Scene::renderPixelMultisampling(const Camera& camera, int i, int j)
+void Scene::applyRenderOptions()
 {
-	// Box Filtering
-	Vec3f color = Vec3f();
-	std::vector<Ray> raysPerPixel;
-
-	if (camera.hasDepthOfField() == true)
+	for (size_t i = 0; i < cameras.size(); i++)
 	{
-		raysPerPixel = sampleRaysDepthOfField(camera, i, j);
-	}
-	else
-	{
-		raysPerPixel = sampleRays(camera, i, j);
-	}
-	
-	for (int r = 0; r < raysPerPixel.size(); r++)
-	{
-		Ray ray = raysPerPixel[r];
+		Camera& camera = cameras[i];
 
-		if (camera.renderingMode == RENDERINGMODE_RAYTRACING)
+		if (options.numberOfSamples > 0)
 		{
-			color += findPixelColor(ray, camera, maxRecursionDepth, i, j);
+			camera.numberOfSamples = options.numberOfSamples;
 		}
-		else if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
+
+		if (options.resolutionScale != 1.0f)
 		{
-			color += findPixelColorPathTracing(ray, camera, maxRecursionDepth, i, j);
+			camera.scaleResolution(options.resolutionScale);
+		}
+
+		if (options.crop == true)
+		{
+			camera.cropImage(options.cropMinX, options.cropMaxX, options.cropMinY, options.cropMaxY);
 		}
-	}
 
-	color = color / camera.numberOfSamples;
+		if (options.outputDirectory.empty() == false)
+		{
+			// Keep only the file name of the image, the scene file may give a directory as well.
+			std::string fileName = camera.imageName;
+			size_t separator = fileName.find_last_of("/\\");
+			if (separator != std::string::npos)
+			{
+				fileName = fileName.substr(separator + 1);
+			}
+			camera.imageName = options.outputDirectory + "/" + fileName;
+		}
 
-	return color;
+		if (options.lightTree == true)
+		{
+			camera.lightTree = true;
+		}
+	}
 }
 
-std::vector<Ray> Scene::sampleRays(const Camera& camera, int i, int j)
+int Scene::getNumberOfPasses(const Camera& camera) const
 {
-	// Jittered Multisampling
-	// Sample rays for a single pixel.
-	std::vector<Ray> raysPerPixel;
+	if (camera.numberOfSamples == 1)
+	{
+		return 1;
+	}
+
+	// Each pass renders one row of the jittered sampling grid.
 	int numberOfMiniPixels = sqrt(camera.numberOfSamples);
+	return numberOfMiniPixels;
+}
 
-	for (int a = 0; a < numberOfMiniPixels; a++)
+bool Scene::resumeCamera(const Camera& camera, CameraRender* render)
+{
+	Checkpoint checkpoint;
+	if (checkpoint.readCheckpoint(render->checkpointName) == false)
 	{
-		for (int b = 0; b < numberOfMiniPixels; b++)
-		{
-			float randx = distribution(randGenerator);
-			float randy = distribution(randGenerator);
+		return false;
+	}
 
-			float dx = (a + randx) / numberOfMiniPixels;
-			float dy = (b + randy) / numberOfMiniPixels;
+	if (checkpoint.matches(camera.imageWidth, camera.imageHeight, camera.numberOfSamples, render->numberOfPasses) == false)
+	{
+		std::cout << "Checkpoint " << render->checkpointName << " does not match the camera, rendering from scratch" << std::endl;
+		return false;
+	}
 
-			float time = distribution(randGenerator);
+	// The remaining passes are sampled from the same seed, so the result is the same as an uninterrupted render.
+	render->pixelColors = checkpoint.accumulation;
+	render->currentPass = checkpoint.completedPasses;
+	render->samplerSeed = checkpoint.samplerSeed;
 
-			Ray ray = generateRay(camera, i, j, time, dx, dy);
-			raysPerPixel.push_back(ray);
-		}
+	std::cout << camera.imageName << " is resumed from pass " << render->currentPass << "/" << render->numberOfPasses << std::endl;
+	return true;
+}
+
+void Scene::writeCheckpoint(const Camera& camera, const CameraRender* render)
+{
+	Checkpoint checkpoint = Checkpoint(camera.imageWidth, camera.imageHeight, camera.numberOfSamples, render->currentPass, render->samplerSeed, render->pixelColors);
+	if (checkpoint.writeCheckpoint(render->checkpointName) == false)
+	{
+		std::cout << "Checkpoint " << render->checkpointName << " cannot be written" << std::endl;
 	}
-	
-	return raysPerPixel;
 }
 
-std::vector<Ray> Scene::sampleRaysDepthOfField(const Camera& camera, int i, int j)
+Vec3f Scene::renderPixelMultisampling(const Camera& camera, int i, int j, int pass)
 {
-	// Sample rays for a single pixel with depth of field camera.
-	std::vector<Ray> raysPerPixel;
+	// Returns the sum of the samples of the given pass, division by the number of samples is done after all passes.
+	// Rays are traced as they are sampled, so that no memory is allocated per pixel.
+	Vec3f color = Vec3f();
 	int numberOfMiniPixels = sqrt(camera.numberOfSamples);
 
-	for (int a = 0; a < numberOfMiniPixels; a++)
+	for (int b = 0; b < numberOfMiniPixels; b++)
 	{
-		for (int b = 0; b < numberOfMiniPixels; b++)
+		Ray ray = sampleRay(camera, i, j, pass, b);
+
+		if (camera.renderingMode == RENDERINGMODE_RAYTRACING)
+		{
+			color += findPixelColor(ray, camera, maxRecursionDepth, i, j);
+		}
+		else if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
 		{
-			float randx = distribution(randGenerator);
-			float randy = distribution(randGenerator);
+			color += findPixelColorPathTracing(ray, camera, maxRecursionDepth, i, j);
+		}
+	}
 
-			float dx = (a + randx) / numberOfMiniPixels;
-			float dy = (b + randy) / numberOfMiniPixels;
+	return color;
+}
 
-			// Distribution is between 0 and 1, subtract 0.5 because center of the aperture is used.
-			float dofRandx = distribution(randGenerator) - 0.5f;
-			float dofRandy = distribution(randGenerator) - 0.5f;
+Ray Scene::sampleRay(const Camera& camera, int i, int j, int a, int b)
+{
+	// Jittered Multisampling
+	// Sample a ray in the cell (a, b) of the sampling grid of a single pixel.
+	int numberOfMiniPixels = sqrt(camera.numberOfSamples);
 
-			float time = distribution(randGenerator);
+	float randx = distribution(randGenerator);
+	float randy = distribution(randGenerator);
 
-			Ray ray = generateRayDepthOfField(camera, i, j, dx, dy, dofRandx, dofRandy, time);
-			raysPerPixel.push_back(ray);
-		}
+	float dx = (a + randx) / numberOfMiniPixels;
+	float dy = (b + randy) / numberOfMiniPixels;
+
+	if (camera.hasDepthOfField() == true)
+	{
+		// Distribution is between 0 and 1, subtract 0.5 because center of the aperture is used.
+		float dofRandx = distribution(randGenerator) - 0.5f;
+		float dofRandy = distribution(randGenerator) - 0.5f;
+
+		float time = distribution(randGenerator);
+		return generateRayDepthOfField(camera, i, j, dx, dy, dofRandx, dofRandy, time);
 	}
 
-	return raysPerPixel;
+	float time = distribution(randGenerator);
+	return generateRay(camera, i, j, time, dx, dy);
 }
 
 Vec3f Scene::renderPixel(const Camera& camera, int i, int j)
@@ -224,16 +416,33 @@ Ray Scene::generateRayDepthOfField(const Camera& camera, int i, int j, float dx,
 	return primaryRay;
 }
 
+bool Scene::findClosestHit(const Ray& ray, Hit& hit)
+{
+	// Traversal keeps only the distance and the primitive of the closest intersection,
+	// normals, texture coordinates and light data are computed once for that one.
+	RayHit rayHit = RayHit();
+	if (bvh->intersection(ray, rayHit) == false)
+	{
+		return false;
+	}
+
+	const Object* object = rayHit.instance ? rayHit.instance : rayHit.primitive;
+	hit = object->getHit(ray, rayHit);
+
+	return true;
+}
+
 Vec3f Scene::findPixelColor(const Ray& ray, const Camera& camera, int depth, int i, int j)
 {
 	Vec3f color = Vec3f();
 
 	Hit hitResult = Hit();
-	bool result = bvh->intersection(ray, hitResult);
+	bool result = findClosestHit(ray, hitResult);
+	Statistics::increment(depth == maxRecursionDepth ? STATISTICS_CAMERARAYS : STATISTICS_SECONDARYRAYS);
 
 	if (result == true)
 	{
-		Material material = materials[hitResult.materialId];
+		const Material& material = camera.materials[hitResult.materialId];
 		Texture *texture = hitResult.texture;
 
 		if (hitResult.isLight == true)
@@ -249,23 +458,34 @@ Vec3f Scene::findPixelColor(const Ray& ray, const Camera& camera, int depth, int
 			return color;
 		}
 
-		applyDegamma(material, camera.tonemap);
-			
 		// Do not add shading if ray is inside an object.
 		if (ray.isInsideObject == false)
 		{
 			color += material.ambient * ambientLight;
 
 			// For each light in the scene, add diffuse and specular shading to the pixel color.
-			for (int i = 0; i < lights.size(); i++)
+			int numberOfLightSamples = getNumberOfLightSamples(camera);
+			for (int i = 0; i < numberOfLightSamples; i++)
 			{
-				Light *currentLight = lights[i];
-				bool shadow = shadowCheck(currentLight, ray, hitResult);				
+				float lightPmf;
+				Light *currentLight = selectLight(camera, hitResult, i, lightPmf);
+				if (currentLight == NULL)
+				{
+					continue;
+				}
+
+				LightSample lightSample = sampleLight(currentLight, hitResult);
+				if (lightSample.pdf <= 0.0f)
+				{
+					continue;
+				}
+
+				Vec3f wi = lightSample.wi;
+				bool shadow = shadowCheck(currentLight, ray, hitResult, lightSample);
 
 				if (shadow == false)
 				{
-					Vec3f wi = currentLight->calculateWi(hitResult.intersectionPoint, hitResult.normal);
-					Vec3f irradiance = currentLight->calculateIrradiance(hitResult.intersectionPoint);
+					Vec3f irradiance = lightSample.radiance / (lightSample.pdf * lightPmf);
 
 					if (material.brdfId > -1)
 					{
@@ -345,24 +565,65 @@ Vec3f Scene::getBackgroundColor(int i, int j, const Ray& ray) const
 	return color;
 }
 
-bool Scene::shadowCheck(Light* light, const Ray& ray, const Hit& hitResult)
+int Scene::getNumberOfLightSamples(const Camera& camera) const
+{
+	// With the light tree, lights at infinity are shaded as before and one more sample is taken from the tree.
+	if (camera.lightTree == true)
+	{
+		return lightBVH->infiniteLights.size() + 1;
+	}
+
+	return lights.size();
+}
+
+Light* Scene::selectLight(const Camera& camera, const Hit& hitResult, int sampleIdx, float& lightPmf)
+{
+	// Light of the given sample and its selection probability, NULL if no light can contribute.
+	lightPmf = 1.0f;
+	if (camera.lightTree == false)
+	{
+		return lights[sampleIdx];
+	}
+
+	if (sampleIdx < (int)lightBVH->infiniteLights.size())
+	{
+		return lightBVH->infiniteLights[sampleIdx];
+	}
+
+	return lightBVH->sampleLight(hitResult.intersectionPoint, hitResult.normal, distribution(randGenerator), lightPmf);
+}
+
+float Scene::getLightPmf(const Camera& camera, const Vec3f& point, const Vec3f& normal, const Light* light) const
+{
+	// Probability that selectLight chooses the light at a point, every light is sampled without the light tree.
+	if (camera.lightTree == false)
+	{
+		return 1.0f;
+	}
+
+	return lightBVH->calculatePmf(point, normal, light);
+}
+
+LightSample Scene::sampleLight(const Light* light, const Hit& hitResult)
+{
+	// Lights draw their random numbers from the scene generator, so a fixed seed reproduces them too.
+	float e1 = distribution(randGenerator);
+	float e2 = distribution(randGenerator);
+	return light->sample(hitResult.intersectionPoint, hitResult.normal, Vec2f(e1, e2));
+}
+
+bool Scene::shadowCheck(Light* light, const Ray& ray, const Hit& hitResult, const LightSample& lightSample)
 {
 	bool shadow = false;
-	Vec3f wi = light->calculateWi(hitResult.intersectionPoint, hitResult.normal);
 
 	Ray shadowRay = Ray();
 	shadowRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
-	shadowRay.direction = wi;
+	shadowRay.direction = lightSample.wi;
 	shadowRay.time = ray.time;
 
-	Hit shadowHit = Hit();
-	bool shadowResult = bvh->intersection(shadowRay, shadowHit);
-
-	float tLight = light->calculateDistance(hitResult.intersectionPoint);
-	if (shadowResult == true && shadowHit.lightObject != light && shadowHit.t < tLight - testEpsilon && shadowHit.t > 0.0f)
-	{
-		shadow = true;
-	}
+	// Any blocker before the light is enough, the closest hit is not needed. The sampled light does not block its own rays.
+	shadow = bvh->occlusion(shadowRay, lightSample.distance - testEpsilon, light);
+	Statistics::increment(STATISTICS_SHADOWRAYS);
 
 	return shadow;
 }
@@ -410,38 +671,8 @@ Vec3f Scene::specularShading(const Vec3f& irradiance, const Vec3f& wi, const Hit
 
 Vec3f Scene::getReflectionColor(const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera, int depth)
 {
-	Vec3f color = Vec3f();
-	Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
-	Vec3f wr = (2 * (hitResult.normal * (wo.dotProduct(hitResult.normal))) - wo).unitVector();
-
-	if (material.roughnessExists == true)
-	{
-		// Construct orthonormal basis uvr.
-		Vec3f rPrime = wr;
-		int minIdx = rPrime.getAbsMinElementIndex();
-		rPrime[minIdx] = 1.0f;
-
-		Vec3f u = wr.crossProduct(rPrime).unitVector();
-		Vec3f v = wr.crossProduct(u).unitVector();
-
-		float randu = distribution(randGenerator) - 0.5f;
-		float randv = distribution(randGenerator) - 0.5f;
-		wr = (wr + material.roughness * (randu * u + randv * v));
-	}
-
-	Ray mirrorRay = Ray();
-	mirrorRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
-	mirrorRay.direction = wr;
-	mirrorRay.time = ray.time;
-
-	if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
-	{
-		color = material.mirror * findPixelColorPathTracing(mirrorRay, camera, depth - 1);
-	}
-	else
-	{
-		color = material.mirror * findPixelColor(mirrorRay, camera, depth - 1);
-	}
+	Ray mirrorRay = getReflectionRay(ray, hitResult, material);
+	Vec3f color = material.mirror * findPixelColor(mirrorRay, camera, depth - 1);
 	return color;
 }
 
@@ -489,15 +720,7 @@ Vec3f Scene::getRefractionColor(const Ray& ray, const Hit& hitResult, const Mate
 		reflectionRay.isInsideObject = true;
 		reflectionRay.time = ray.time;
 
-		Vec3f reflectionColor = Vec3f();
-		if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
-		{
-			reflectionColor = findPixelColorPathTracing(reflectionRay, camera, depth - 1);
-		}
-		else
-		{
-			reflectionColor = findPixelColor(reflectionRay, camera, depth - 1);
-		}
+		Vec3f reflectionColor = findPixelColor(reflectionRay, camera, depth - 1);
 		color = transparency * reflectionColor;
 	}
 	else
@@ -509,15 +732,7 @@ Vec3f Scene::getRefractionColor(const Ray& ray, const Hit& hitResult, const Mate
 		// If entering ray, refraction is inside. Else, outside.
 		refractionRay.isInsideObject = entering;
 
-		Vec3f refractionColor = Vec3f();
-		if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
-		{
-			refractionColor = findPixelColorPathTracing(refractionRay, camera, depth - 1);
-		}
-		else
-		{
-			refractionColor = findPixelColor(refractionRay, camera, depth - 1);
-		}
+		Vec3f refractionColor = findPixelColor(refractionRay, camera, depth - 1);
 
 		Ray reflectionRay = Ray();
 		reflectionRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * wr;
@@ -526,15 +741,7 @@ Vec3f Scene::getRefractionColor(const Ray& ray, const Hit& hitResult, const Mate
 		// If entering ray, reflection is outside. Else, inside.
 		reflectionRay.isInsideObject = !entering;
 
-		Vec3f reflectionColor = Vec3f();
-		if (camera.renderingMode == RENDERINGMODE_PATHTRACING)
-		{
-			reflectionColor = findPixelColorPathTracing(reflectionRay, camera, depth - 1);
-		}
-		else
-		{
-			reflectionColor = findPixelColor(reflectionRay, camera, depth - 1);
-		}
+		Vec3f reflectionColor = findPixelColor(reflectionRay, camera, depth - 1);
 		color = transparency * ((fr * reflectionColor) + (refractionColor * ft));
 	}
 
@@ -591,6 +798,16 @@ float Scene::findReflectionRatioConductor(float cosTheta, float n, float k)
 	return fr;
 }
 
+void Scene::setCameraMaterials(Camera& camera)
+{
+	// Degamma depends only on the tonemap, so it is applied once here instead of at every hit.
+	camera.materials = materials;
+	for (size_t i = 0; i < camera.materials.size(); i++)
+	{
+		applyDegamma(camera.materials[i], camera.tonemap);
+	}
+}
+
 void Scene::applyDegamma(Material& material, const Tonemap& tonemap)
 {
 	if (tonemap.tonemapOperator != TMO_NONE && material.degamma == true)
@@ -603,186 +820,356 @@ void Scene::applyDegamma(Material& material, const Tonemap& tonemap)
 	}
 }
 
-Vec3f Scene::findPixelColorPathTracing(const Ray& ray, const Camera& camera, int depth, int i, int j)
+Vec3f Scene::findPixelColorPathTracing(const Ray& primaryRay, const Camera& camera, int depth, int i, int j)
 {
+	// Iterative path tracing, a single ray is continued at every bounce and the product of the lobe weights is kept in throughput.
 	Vec3f color = Vec3f();
+	Vec3f throughput = Vec3f(1.0f, 1.0f, 1.0f);
+	float lobePdf = 0.0f;	// pdf of the direction of the current ray if it is sampled from the diffuse lobe
+	Vec3f lobeNormal;		// normal at the origin of the current ray
+	Ray ray = primaryRay;
 
-	Hit hitResult = Hit();
-	bool result = bvh->intersection(ray, hitResult);
-
-	if (result == true)
+	for (;; depth--)
 	{
-		Material material = materials[hitResult.materialId];
+		Hit hitResult = Hit();
+		bool result = findClosestHit(ray, hitResult);
+		Statistics::increment(depth == maxRecursionDepth ? STATISTICS_CAMERARAYS : STATISTICS_SECONDARYRAYS);
+
+		if (result == false)
+		{
+			// No hit happened
+			if (maxRecursionDepth == depth)
+			{
+				// Primary ray, pixel's color is background color or background texture.
+				color += throughput * getBackgroundColor(i, j, ray);
+			}
+			// If ray is not primary ray, path does not gather any light.
+			break;
+		}
+
+		const Material& material = camera.materials[hitResult.materialId];
 		Texture *texture = hitResult.texture;
 
 		if (hitResult.isLight == true)
 		{
-			if (camera.nextEventEstimation == true && ray.indirect == true)
+			// With next event estimation, lights hit by indirect rays are already sampled at the previous vertex.
+			// With multiple importance sampling, both samples are kept and weighted by their pdfs.
+			if (camera.nextEventEstimation == false || ray.indirect == false)
 			{
-				return color;
+				color += throughput * hitResult.radiance;
 			}
-			else
+			else if (camera.multipleImportanceSampling == true)
 			{
-				color = hitResult.radiance;
-				return color;
+				color += throughput * hitResult.radiance * getLightHitWeight(ray, hitResult, lobePdf, lobeNormal, camera);
 			}
+			break;
 		}
 
 		if (texture && texture->getDecalMode() == DECALMODE_REPLACEALL)
 		{
 			// If mode is replace_all, disable all shading and directly paste the texture color.
-			color = texture->getTextureColor(hitResult.uvTexture, hitResult.intersectionPoint);
-			return color;
+			color += throughput * texture->getTextureColor(hitResult.uvTexture, hitResult.intersectionPoint);
+			break;
 		}
 
-		applyDegamma(material, camera.tonemap);
-
 		// Do not add shading if ray is inside an object.
 		if (ray.isInsideObject == false)
 		{
-			color += material.ambient * ambientLight;
-			
+			Vec3f localColor = material.ambient * ambientLight;
+
 			if (camera.nextEventEstimation == true)
 			{
-				color += getDirectLightingColor(ray, hitResult, material, texture);
+				localColor += getDirectLightingColor(ray, hitResult, material, texture, camera, depth);
 			}
 
-			color += getIndirectLightingColor(ray, hitResult, material, texture, camera, depth, i, j);
+			color += throughput * localColor;
 		}
 
-		// Specular Reflection
-		if (material.type == MATERIALTYPE_MIRROR && depth > 0)
+		Ray nextRay = Ray();
+		Vec3f weight = Vec3f();
+		if (samplePathLobe(ray, hitResult, material, texture, camera, depth, nextRay, weight, lobePdf) == false)
 		{
-			color += getReflectionColor(ray, hitResult, material, camera, depth);
+			break;
 		}
+		throughput = throughput * weight;
 
-		// Refraction
-		if (material.type == MATERIALTYPE_DIELECTRIC && depth > 0)
+		if (camera.russianRoulette == true && depth < maxRecursionDepth)
 		{
-			color += getRefractionColor(ray, hitResult, material, camera, depth);
+			// Terminate paths that carry little energy, survivors are weighted up to keep the estimate unbiased.
+			float survival = std::min(0.95f, throughput.getMax());
+			if (distribution(randGenerator) >= survival)
+			{
+				break;
+			}
+			throughput = throughput / survival;
 		}
 
-		// Reflection
-		if (material.type == MATERIALTYPE_CONDUCTOR && depth > 0)
+		lobeNormal = hitResult.normal;
+		ray = nextRay;
+	}
+
+	return color;
+}
+
+bool Scene::samplePathLobe(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth,
+	Ray& nextRay, Vec3f& weight, float& lobePdf)
+{
+	// Diffuse and glossy reflection, sampled over the hemisphere.
+	// If russian roulette is enabled, do not check recursion depth.
+	bool diffuseLobe = ray.isInsideObject == false && (camera.russianRoulette == true || depth > 0);
+	Ray diffuseRay = Ray();
+	Vec3f diffuseWeight = Vec3f();
+	float diffusePdf = 0.0f;
+
+	if (diffuseLobe == true)
+	{
+		Vec3f wi = sampleDirection(ray, hitResult, material, camera, diffusePdf);
+		if (diffusePdf > 0.0f)
+		{
+			diffuseWeight = surfaceShading(Vec3f(1.0f, 1.0f, 1.0f), wi, ray, hitResult, material, texture) / diffusePdf;
+		}
+
+		diffuseRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
+		diffuseRay.direction = wi;
+		diffuseRay.time = ray.time;
+		diffuseRay.indirect = true;
+	}
+
+	// Perfect or glossy specular lobe of mirrors, dielectrics and conductors.
+	bool specularLobe = false;
+	Ray specularRay = Ray();
+	Vec3f specularWeight = Vec3f();
+
+	if (depth > 0)
+	{
+		if (material.type == MATERIALTYPE_MIRROR)
+		{
+			specularLobe = true;
+			specularRay = getReflectionRay(ray, hitResult, material);
+			specularWeight = material.mirror;
+		}
+		else if (material.type == MATERIALTYPE_DIELECTRIC)
+		{
+			specularLobe = true;
+			specularRay = sampleDielectricRay(ray, hitResult, material, specularWeight);
+		}
+		else if (material.type == MATERIALTYPE_CONDUCTOR)
 		{
 			float cosTheta = -1 * ray.direction.dotProduct(hitResult.normal);
 			float fr = findReflectionRatioConductor(cosTheta, material.refractionIndex, material.absorptionIndex);
 
-			color += fr * getReflectionColor(ray, hitResult, material, camera, depth);
+			specularLobe = true;
+			specularRay = getReflectionRay(ray, hitResult, material);
+			specularWeight = fr * material.mirror;
 		}
 	}
+
+	// Continue with one of the lobes, chosen proportional to their weights.
+	float diffuseImportance = diffuseLobe ? diffuseWeight.getMax() : 0.0f;
+	float specularImportance = specularLobe ? specularWeight.getMax() : 0.0f;
+	float totalImportance = diffuseImportance + specularImportance;
+	if (totalImportance <= 0.0f)
+	{
+		return false;
+	}
+
+	float diffuseProbability = diffuseImportance / totalImportance;
+	if (diffuseProbability > 0.0f && distribution(randGenerator) < diffuseProbability)
+	{
+		nextRay = diffuseRay;
+		weight = diffuseWeight / diffuseProbability;
+		lobePdf = diffusePdf;
+	}
 	else
 	{
-		// No hit happened
-		if (maxRecursionDepth == depth)
-		{
-			// Primary ray, pixel's color is background color or background texture.
-			color = getBackgroundColor(i, j, ray);
-		}
-		// If ray is not primary ray, pixel's color is (0,0,0).
+		nextRay = specularRay;
+		weight = specularWeight / (1.0f - diffuseProbability);
+		lobePdf = 0.0f;
 	}
 
-	return color;
+	return true;
 }
 
-Vec3f Scene::getDirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture)
+Ray Scene::getReflectionRay(const Ray& ray, const Hit& hitResult, const Material& material)
 {
-	Vec3f color = Vec3f();
+	Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
+	Vec3f wr = (2 * (hitResult.normal * (wo.dotProduct(hitResult.normal))) - wo).unitVector();
 
-	// For each light in the scene, add diffuse and specular shading to the pixel color.
-	for (int i = 0; i < lights.size(); i++)
+	if (material.roughnessExists == true)
 	{
-		Light *currentLight = lights[i];
-		bool shadow = shadowCheck(currentLight, ray, hitResult);
-		
-		if (shadow == false)
-		{
-			Vec3f wi = currentLight->calculateWi(hitResult.intersectionPoint, hitResult.normal);
-			Vec3f irradiance = currentLight->calculateIrradiance(hitResult.intersectionPoint);
+		// Construct orthonormal basis uvr.
+		Vec3f rPrime = wr;
+		int minIdx = rPrime.getAbsMinElementIndex();
+		rPrime[minIdx] = 1.0f;
 
-			if (material.brdfId > -1)
-			{
-				// BRDF exists
-				BRDF *brdf = brdfs[material.brdfId];
-				Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
-				color += brdf->getBRDFValue(hitResult, material, wi, wo, irradiance);
-			}
-			else
-			{
-				Vec3f diffuse = diffuseShading(irradiance, wi, hitResult, material, texture);
-				Vec3f specular = specularShading(irradiance, wi, hitResult, material, ray);
-				color += diffuse + specular;
-			}
-		}
+		Vec3f u = wr.crossProduct(rPrime).unitVector();
+		Vec3f v = wr.crossProduct(u).unitVector();
+
+		float randu = distribution(randGenerator) - 0.5f;
+		float randv = distribution(randGenerator) - 0.5f;
+		wr = (wr + material.roughness * (randu * u + randv * v));
 	}
-	return color;
+
+	Ray mirrorRay = Ray();
+	mirrorRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
+	mirrorRay.direction = wr;
+	mirrorRay.time = ray.time;
+
+	return mirrorRay;
 }
 
-Vec3f Scene::getIndirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth, int i, int j)
+Ray Scene::sampleDielectricRay(const Ray& ray, const Hit& hitResult, const Material& material, Vec3f& weight)
 {
-	Vec3f color = Vec3f();
-	if (camera.russianRoulette == false && depth <= 0)
+	// Either reflection or refraction is followed, reflection is chosen with probability equal to the Fresnel reflection ratio.
+	Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
+	Vec3f wr = (2 * (hitResult.normal * (wo.dotProduct(hitResult.normal))) - wo).unitVector();
+	Vec3f wt = Vec3f();
+
+	float n1 = 1.0f;
+	float n2 = material.refractionIndex;
+	Vec3f normal = hitResult.normal;
+	weight = Vec3f(1.0f, 1.0f, 1.0f);
+
+	float cosTheta = -1 * ray.direction.dotProduct(hitResult.normal);
+	bool entering = cosTheta > 0.0f;
+
+	if (entering == false)
 	{
-		// If russian roulette is enabled, do not check recursion depth.
-		return color;
+		// Exiting ray, light is absorbed along the path inside the object.
+		cosTheta = std::abs(cosTheta);
+		std::swap(n1, n2);
+		normal = -1 * normal;
+
+		weight.x = expf(-1 * material.absorption.x * hitResult.t);
+		weight.y = expf(-1 * material.absorption.y * hitResult.t);
+		weight.z = expf(-1 * material.absorption.z * hitResult.t);
 	}
 
-	Vec3f wi = sampleDirection(hitResult.normal, camera);
+	float fr = findReflectionRatioDielectric(cosTheta, n1, n2);
 
-	// Check if ray is terminated with Russian Roulette.
-	float cosTheta = std::max(0.001f, wi.dotProduct(hitResult.normal));
-	float q = 1.0f - cosTheta;
-	if (camera.russianRoulette == true)
-	{		
-		float rand = distribution(randGenerator);
-		if (rand <= q)
-		{
-			return color;
-		}
-	}	
+	Ray nextRay = Ray();
+	nextRay.time = ray.time;
 
-	Ray sampleRay = Ray();
-	sampleRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
-	sampleRay.direction = wi;
-	sampleRay.time = ray.time;
-	sampleRay.indirect = true;
+	if (fr == 1.0f || distribution(randGenerator) < fr)
+	{
+		// Reflection, also taken when total internal reflection happened.
+		// If entering ray, reflection is outside. Else, inside.
+		nextRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * wr;
+		nextRay.direction = wr;
+		nextRay.isInsideObject = !entering;
+	}
+	else
+	{
+		// If entering ray, refraction is inside. Else, outside.
+		refractRay(ray.direction, normal, n1, n2, wt);
+		nextRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * wt;
+		nextRay.direction = wt;
+		nextRay.isInsideObject = entering;
+	}
 
-	Vec3f indirectRadiance = findPixelColorPathTracing(sampleRay, camera, depth - 1, i, j);
+	return nextRay;
+}
 
+Vec3f Scene::surfaceShading(const Vec3f& irradiance, const Vec3f& wi, const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture)
+{
 	if (material.brdfId > -1)
 	{
 		// BRDF exists
 		BRDF *brdf = brdfs[material.brdfId];
 		Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
-		color += brdf->getBRDFValue(hitResult, material, wi, wo, indirectRadiance);
+		return brdf->getBRDFValue(hitResult, material, wi, wo, irradiance);
 	}
-	else
+
+	Vec3f diffuse = diffuseShading(irradiance, wi, hitResult, material, texture);
+	Vec3f specular = specularShading(irradiance, wi, hitResult, material, ray);
+	return diffuse + specular;
+}
+
+Vec3f Scene::getDirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth)
+{
+	Vec3f color = Vec3f();
+
+	// For each light in the scene, add diffuse and specular shading to the pixel color.
+	int numberOfLightSamples = getNumberOfLightSamples(camera);
+	for (int i = 0; i < numberOfLightSamples; i++)
 	{
-		Vec3f diffuse = diffuseShading(indirectRadiance, wi, hitResult, material, texture);
-		Vec3f specular = specularShading(indirectRadiance, wi, hitResult, material, ray);
-		color += diffuse + specular;
+		float lightPmf;
+		Light *currentLight = selectLight(camera, hitResult, i, lightPmf);
+		if (currentLight == NULL)
+		{
+			continue;
+		}
+
+		LightSample lightSample = sampleLight(currentLight, hitResult);
+		if (lightSample.pdf <= 0.0f)
+		{
+			continue;
+		}
+
+		Vec3f wi = lightSample.wi;
+		bool shadow = shadowCheck(currentLight, ray, hitResult, lightSample);
+		
+		if (shadow == false)
+		{
+			Vec3f irradiance = lightSample.radiance / (lightSample.pdf * lightPmf);
+
+			float lightWeight = getLightSampleWeight(lightSample, lightPmf, ray, hitResult, material, camera, depth);
+			color += surfaceShading(irradiance, wi, ray, hitResult, material, texture) * lightWeight;
+		}
 	}
-	
-	float pw = 1.0f / (2 * PI);	// Uniform sampling
-	if (camera.importanceSampling == true)
+	return color;
+}
+
+float Scene::getLightSampleWeight(const LightSample& lightSample, float lightPmf, const Ray& ray, const Hit& hitResult, const Material& material,
+	const Camera& camera, int depth)
+{
+	// Weight of a light sample in multiple importance sampling.
+	// Light cannot be hit by rays, light sampling is the only strategy.
+	if (camera.multipleImportanceSampling == false || lightSample.intersectable == false)
 	{
-		pw = cosTheta / PI;
+		return 1.0f;
 	}
-	color = color / pw;
 
-	if (camera.russianRoulette == true)
+	Vec3f wi = lightSample.wi;
+	float lightPdf = lightSample.pdf * lightPmf;
+
+	// Path continues with a BRDF sample only if the diffuse lobe can be sampled at this depth.
+	float lobePdf = 0.0f;
+	if (camera.russianRoulette == true || depth > 0)
 	{
-		color = color / (1.0f - q);
+		lobePdf = getDirectionPdf(wi, ray, hitResult, material, camera);
 	}
 
-	return color;
+	return powerHeuristic(lightPdf, lobePdf);
 }
 
-Vec3f Scene::sampleDirection(const Vec3f& normal, const Camera& camera)
+float Scene::getLightHitWeight(const Ray& ray, const Hit& hitResult, float lobePdf, const Vec3f& lobeNormal, const Camera& camera)
+{
+	// Weight of a light hit by a BRDF sampled ray, light sampling at the previous vertex could have chosen the same point.
+	// lobeNormal is the normal at the previous vertex, the light tree used it to select lights there.
+	if (hitResult.lightObject == NULL)
+	{
+		return 1.0f;
+	}
+
+	float lightPmf = getLightPmf(camera, ray.origin, lobeNormal, hitResult.lightObject);
+	float lightPdf = hitResult.lightObject->calculateHitPdf(ray.origin, hitResult) * lightPmf;
+	return powerHeuristic(lobePdf, lightPdf);
+}
+
+Vec3f Scene::sampleDirection(const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera, float& pdf)
 {
 	float e1 = distribution(randGenerator);
 	float e2 = distribution(randGenerator);
 
+	if (material.brdfId > -1 && camera.importanceSampling == true)
+	{
+		// Sample the lobes of the BRDF, glossy models need far fewer samples than with cosine weighted directions.
+		BRDF *brdf = brdfs[material.brdfId];
+		Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
+		return brdf->sample(hitResult, material, wo, Vec2f(e1, e2), pdf);
+	}
+
 	float phi = 2 * PI * e1;
 	float theta = acos(e2);	// Uniform sampling
 
@@ -792,7 +1179,7 @@ Vec3f Scene::sampleDirection(const Vec3f& normal, const Camera& camera)
 	}
 
 	// Construct orthonormal basis uvw.
-	Vec3f w = normal;
+	Vec3f w = hitResult.normal;
 	Vec3f wPrime = w;
 	int minIdx = wPrime.getAbsMinElementIndex();
 	wPrime[minIdx] = 1.0f;
@@ -801,23 +1188,44 @@ Vec3f Scene::sampleDirection(const Vec3f& normal, const Camera& camera)
 	Vec3f v = u.crossProduct(w).unitVector();
 
 	Vec3f wi = (w * cos(theta) + v * sin(theta) * cos(phi) + u * sin(theta) * sin(phi)).unitVector();
+	pdf = getDirectionPdf(wi, ray, hitResult, material, camera);
 	return wi;
 }
 
-Scene::~Scene()
+float Scene::getDirectionPdf(const Vec3f& wi, const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera) const
 {
-	if (bvh)
+	// Solid angle pdf of the directions generated by sampleDirection.
+	if (material.brdfId > -1 && camera.importanceSampling == true)
+	{
+		BRDF *brdf = brdfs[material.brdfId];
+		Vec3f wo = (ray.origin - hitResult.intersectionPoint).unitVector();
+		return brdf->pdf(hitResult, material, wi, wo);
+	}
+
+	if (camera.importanceSampling == true)
 	{
-		delete bvh;
+		float cosTheta = std::max(0.001f, wi.dotProduct(hitResult.normal));
+		return cosTheta / PI;
 	}
 
-	if (backgroundTexture)
+	return 1.0f / (2 * PI);	// Uniform sampling
+}
+
+Scene::~Scene()
+{
+	// Objects only point to the textures, the background texture is one of them too.
+	for (size_t i = 0; i < textures.size(); i++)
 	{
-		delete backgroundTexture;
+		delete textures[i];
 	}
 
 	if (sphericalDirLight)
 	{
 		delete sphericalDirLight;
 	}
+
+	if (lightBVH)
+	{
+		delete lightBVH;
+	}
 }
\ No newline at end of file
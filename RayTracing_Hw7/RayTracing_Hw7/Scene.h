@@ -3,12 +3,14 @@
 
 #include "Vec2f.h"
 #include "Vec3f.h"
-#include "Vertex.h"
+#include "OctahedralNormal.h"
 #include <vector>
 #include <cmath>
 #include <random>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 #include "tinyxml2\tinyxml2.h"
-#include "happly\happly.h"
 #include "Image.h"
 #include "Camera.h"
 #include "Light.h"
@@ -18,6 +20,8 @@
 #include "Sphere.h"
 #include "Ray.h"
 #include "BVH.h"
+#include "MemoryArena.h"
+#include "PlyLoader.h"
 #include "Transformation.h"
 #include "ImageTexture.h"
 #include "PerlinTexture.h"
@@ -26,6 +30,26 @@
 #include "BRDF.h"
 #include "LightMesh.h"
 #include "LightSphere.h"
+#include "Checkpoint.h"
+#include "ThreadPool.h"
+#include "RenderOptions.h"
+#include "Statistics.h"
+#include "PathBuffer.h"
+#include "LightBVH.h"
+
+// Render state of a single camera, shared by the tile tasks of that camera.
+struct CameraRender
+{
+	int cameraIdx;
+	std::vector<Vec3f> pixelColors;		// accumulated samples of all passes
+	int numberOfPasses;
+	int currentPass;
+	unsigned int samplerSeed;			// the tile samplers are derived from it, kept by checkpoints
+	std::atomic<int> remainingTiles;	// tiles of the current pass that are not rendered yet
+	std::string checkpointName;
+	std::chrono::system_clock::time_point start;
+	std::chrono::system_clock::time_point lastCheckpoint;
+};
 
 class Scene
 {
@@ -35,14 +59,17 @@ public:
 	float testEpsilon;
 	int maxRecursionDepth;
 	Vec3f ambientLight;
-	Object* bvh;
+	MemoryArena arena;		// owns the objects and the bvh nodes, they are released together with the scene
+	BVH* bvh;
 	ImageTexture* backgroundTexture;
 	SphericalDirectionalLight* sphericalDirLight;
+	LightBVH* lightBVH;
 
 	std::vector<Camera> cameras;
 	std::vector<Light*> lights;
 	std::vector<Material> materials;
-    std::vector<Vertex> vertexData;
+	std::vector<Vec3f> vertexPositions;				// shared by all meshes, triangles and spheres index into it
+	std::vector<OctahedralNormal> vertexNormals;	// smooth shading normals, same indices as the positions
     std::vector<Mesh*> baseMeshes;
 	std::vector<Translation> translations;
 	std::vector<Scaling> scalings;
@@ -50,47 +77,91 @@ public:
 	std::vector<Composite> composites;
 	std::vector<Texture*> textures;
 	std::vector<Vec2f> textureCoordData;
+	std::vector<Vec3f> vertexNormalSums;	// face normals added up per vertex while loading, encoded into vertexNormals at the end
 	std::vector<BRDF*> brdfs;
 
+	RenderOptions options;		// command line overrides, set before loading the scene
+	bool deferImageWriting;		// keep the rendered images in images instead of writing them, see writeImages
+	std::vector<Image> images;	// rendered image of each camera if image writing is deferred
+
+	Scene();
+
 	// Parser
 	void loadSceneFromXml(const std::string& filepath);
 	
 	void renderScene();
-	void renderScenePartial(int minHeight, int maxHeight, int cameraIdx, std::vector<Vec3f>& pixelColors);
+	void renderScene(ThreadPool& threadPool);
+	void renderTile(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, std::vector<Vec3f>& pixelColors);
+	void writeImages() const;
 	Vec3f renderPixel(const Camera& camera, int i, int j);
-	Vec3f renderPixelMultisampling(const Camera& camera, int i, int j);
+	Vec3f renderPixelMultisampling(const Camera& camera, int i, int j, int pass);
 	Ray generateRay(const Camera& camera, int i, int j, float time, float dx = 0.5f, float dy = 0.5f);
 	Ray generateRayDepthOfField(const Camera& camera, int i, int j, float dx, float dy, float dofRandx, float dofRandy, float time);
 	bool refractRay(Vec3f direction, Vec3f normal, float n1, float n2, Vec3f& wt);
 	float findReflectionRatioDielectric(float cosTheta, float n1, float n2);
 	float findReflectionRatioConductor(float cosTheta, float n1, float n2);
-	std::vector<Ray> sampleRays(const Camera& camera, int i, int j);
-	std::vector<Ray> sampleRaysDepthOfField(const Camera& camera, int i, int j);
+	Ray sampleRay(const Camera& camera, int i, int j, int a, int b);
 	Vec3f findPixelColor(const Ray& ray, const Camera& camera, int depth, int i = 0, int j = 0);
-	Vec3f findPixelColorPathTracing(const Ray& ray, const Camera& camera, int depth, int i = 0, int j = 0);
+	Vec3f findPixelColorPathTracing(const Ray& primaryRay, const Camera& camera, int depth, int i = 0, int j = 0);
 	~Scene();
 
 private:
-	std::default_random_engine randGenerator;
-	std::uniform_real_distribution<float> distribution;
+	unsigned int samplerSeed;	// seed of the cameras that do not resume from a checkpoint
+	static thread_local std::default_random_engine randGenerator;	// sampler of the tile the thread is rendering
+	static thread_local std::uniform_real_distribution<float> distribution;
+	std::mutex outputMutex;
+
+	void addTileTasks(ThreadPool& threadPool, CameraRender* render);
+	void seedTileSampler(const CameraRender* render, int pass, int tileIdx);
+	void finishPass(ThreadPool& threadPool, CameraRender* render);
+	void finishCamera(CameraRender* render);
 
-	bool shadowCheck(Light* light, const Ray& ray, const Hit& hitResult);
+	bool findClosestHit(const Ray& ray, Hit& hit);
+	LightSample sampleLight(const Light* light, const Hit& hitResult);
+	bool shadowCheck(Light* light, const Ray& ray, const Hit& hitResult, const LightSample& lightSample);
+	int getNumberOfLightSamples(const Camera& camera) const;
+	Light* selectLight(const Camera& camera, const Hit& hitResult, int sampleIdx, float& lightPmf);
+	float getLightPmf(const Camera& camera, const Vec3f& point, const Vec3f& normal, const Light* light) const;
 	Vec3f diffuseShading(const Vec3f& irradiance, const Vec3f& wi, const Hit& hit, const Material& material, const Texture* texture);
 	Vec3f specularShading(const Vec3f& irradiance, const Vec3f& wi, const Hit& hit, const Material& material, const Ray& ray);
+	Vec3f surfaceShading(const Vec3f& irradiance, const Vec3f& wi, const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture);
+	Ray getReflectionRay(const Ray& ray, const Hit& hitResult, const Material& material);
 	Vec3f getReflectionColor(const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera, int depth);
 	Vec3f getRefractionColor(const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera, int depth);
 	Vec3f getBackgroundColor(int i, int j, const Ray& ray) const;
+	void setCameraMaterials(Camera& camera);
 	void applyDegamma(Material& material, const Tonemap& tonemap);
+	void applyRenderOptions();
+	int getNumberOfPasses(const Camera& camera) const;
+	bool resumeCamera(const Camera& camera, CameraRender* render);
+	void writeCheckpoint(const Camera& camera, const CameraRender* render);
 
 	// Path Tracing
-	Vec3f getDirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture);
-	Vec3f getIndirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth, int i, int j);
-	Vec3f sampleDirection(const Vec3f& normal, const Camera& camera);
+	Vec3f getDirectLightingColor(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth);
+	float getLightSampleWeight(const LightSample& lightSample, float lightPmf, const Ray& ray, const Hit& hitResult, const Material& material,
+		const Camera& camera, int depth);
+	float getLightHitWeight(const Ray& ray, const Hit& hitResult, float lobePdf, const Vec3f& lobeNormal, const Camera& camera);
+	bool samplePathLobe(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth,
+		Ray& nextRay, Vec3f& weight, float& lobePdf);
+	Ray sampleDielectricRay(const Ray& ray, const Hit& hitResult, const Material& material, Vec3f& weight);
+	Vec3f sampleDirection(const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera, float& pdf);
+	float getDirectionPdf(const Vec3f& wi, const Ray& ray, const Hit& hitResult, const Material& material, const Camera& camera) const;
+
+	// Wavefront Path Tracing
+	void renderTileWavefront(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, std::vector<Vec3f>& pixelColors);
+	void generatePaths(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, PathBuffer& paths);
+	void sortPaths(PathBuffer& paths);
+	void extendPaths(PathBuffer& paths, int depth);
+	void shadePaths(const Camera& camera, int depth, PathBuffer& paths, ShadowRayBuffer& shadowRays, std::vector<Vec3f>& pixelColors);
+	void addShadowRays(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth,
+		const Vec3f& throughput, int pixelIndex, ShadowRayBuffer& shadowRays);
+	void traceShadowRays(const ShadowRayBuffer& shadowRays, std::vector<Vec3f>& pixelColors);
 
 	// Parser
-	void applyTransformations(tinyxml2::XMLElement* element, std::stringstream& stream, Matrix4f& matrix);
+	void applyTransformations(tinyxml2::XMLElement* element, std::stringstream& stream, AffineTransform& transformation);
 	void parsePlyFile(const std::string& filepath, const std::string& plyFile, std::vector<Object*>& triangles,
 		ShadingMode shadingMode, int materialId, Texture* texture, Texture* normalTexture, int vertexOffset, int textureOffset);
+	void parseMotionKeyframes(tinyxml2::XMLElement* element, std::stringstream& stream, Object* object);
 	void getRendererParams(tinyxml2::XMLElement* element, std::stringstream& stream, Camera& camera);
 };
 
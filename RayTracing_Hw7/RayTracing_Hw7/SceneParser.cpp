@@ -83,6 +83,15 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		}
 		camera.orientation = cameraOrientation;
 
+		// Renderer parameters are off unless the camera enables them, the same camera object is reused for every element.
+		camera.nextEventEstimation = false;
+		camera.russianRoulette = false;
+		camera.importanceSampling = false;
+		camera.multipleImportanceSampling = false;
+		camera.wavefront = false;
+		camera.raySorting = false;
+		camera.lightTree = false;
+
 		auto type = element->Attribute("type");
 		if (!type)
 		{
@@ -280,10 +289,6 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			}
 
 			// Get renderer parameters
-			camera.nextEventEstimation = false;
-			camera.russianRoulette = false;
-			camera.importanceSampling = false;
-
 			child = element->FirstChildElement("RendererParams");
 			if (child)
 			{
@@ -782,7 +787,9 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 				stream >> noiseScale;
 				stream >> bumpFactor;
 
-				PerlinTexture *perlinTexture = new PerlinTexture(decalMode, noiseConversion, noiseScale, bumpFactor);
+				// A fixed seed from the command line also fixes the noise pattern.
+				unsigned int noiseSeed = options.fixedSeed ? options.seed : std::chrono::system_clock::now().time_since_epoch().count();
+				PerlinTexture *perlinTexture = new PerlinTexture(decalMode, noiseConversion, noiseScale, bumpFactor, noiseSeed);
 				textures.push_back(perlinTexture);
 			}
 			else if (strcmp(type, "checkerboard") == 0)
@@ -932,9 +939,10 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		while (!(stream >> vertex.x).eof())
 		{
 			stream >> vertex.y >> vertex.z;
-			vertexData.push_back(Vertex(vertex));
+			vertexPositions.push_back(vertex);
 		}
 	}
+	vertexNormalSums.resize(vertexPositions.size());
 	stream.clear();
 
 	// Get TexCoordData
@@ -1023,15 +1031,15 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 				int vertexIndices[3] = { vertexOffset + v0, vertexOffset + v1, vertexOffset + v2 };
 				int textureIndices[3] = { textureOffset + v0, textureOffset + v1, textureOffset + v2 };
 
-				Triangle *triangle = new Triangle(this, vertexIndices, textureIndices, materialId, texture, normalTexture, shadingMode,
-					Matrix4f(1.0f), false, Vec3f(0.0f, 0.0f, 0.0f), false);
+				Triangle *triangle = arena.create<Triangle>(this, vertexIndices, textureIndices, materialId, texture, normalTexture, shadingMode,
+					AffineTransform(), false, Vec3f(0.0f, 0.0f, 0.0f), false);
 				triangles.push_back(triangle);
 
 				if (shadingMode == SHADINGMODE_SMOOTH)
 				{
-					vertexData[v0].addToVertexNormal(triangle->normal);
-					vertexData[v1].addToVertexNormal(triangle->normal);
-					vertexData[v2].addToVertexNormal(triangle->normal);
+					vertexNormalSums[v0] += triangle->normal;
+					vertexNormalSums[v1] += triangle->normal;
+					vertexNormalSums[v2] += triangle->normal;
 				}
 			}
 			stream.clear();
@@ -1042,7 +1050,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		}
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1060,7 +1068,8 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		Mesh* baseMesh = new Mesh(this, materialId, texture, normalTexture, triangles, transformationMat, transform, motionVec, motionBlur);
+		Mesh* baseMesh = arena.create<Mesh>(arena, this, materialId, texture, normalTexture, triangles, transformationMat, transform, motionVec, motionBlur);
+		parseMotionKeyframes(element, stream, baseMesh);
 		baseMeshes.push_back(baseMesh);
 		objects.push_back(baseMesh);
 		element = element->NextSiblingElement("Mesh");
@@ -1117,7 +1126,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		stream.clear();
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1129,7 +1138,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			}
 			else
 			{
-				transformationMat = baseMesh->transformationMatrix;
+				transformationMat = baseMesh->transformation;
 				applyTransformations(child, stream, transformationMat);
 			}
 		}
@@ -1144,7 +1153,9 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		objects.push_back(new MeshInstance(this, materialId, texture, normalTexture, baseMesh->bvh, transformationMat, transform, motionVec, motionBlur));
+		MeshInstance* meshInstance = arena.create<MeshInstance>(this, materialId, texture, normalTexture, baseMesh->bvh, transformationMat, transform, motionVec, motionBlur);
+		parseMotionKeyframes(element, stream, meshInstance);
+		objects.push_back(meshInstance);
 		element = element->NextSiblingElement("MeshInstance");
 	}
 
@@ -1175,7 +1186,9 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		auto plyFile = child->Attribute("plyFile");
 		if (!plyFile)
 		{
-			stream << child->GetText() << std::endl;
+			// An empty face list leaves the mesh without triangles, it is rejected below.
+			const char* faceText = child->GetText();
+			stream << (faceText ? faceText : "") << std::endl;
 			int v0, v1, v2;
 			while (!(stream >> v0).eof())
 			{
@@ -1184,8 +1197,8 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 				int vertexIndices[3] = { vertexOffset + v0, vertexOffset + v1, vertexOffset + v2 };
 				int textureIndices[3] = { textureOffset + v0, textureOffset + v1, textureOffset + v2 };
 
-				Triangle *triangle = new Triangle(this, vertexIndices, textureIndices, materialId, texture, normalTexture, SHADINGMODE_FLAT,
-					Matrix4f(1.0f), false, Vec3f(0.0f, 0.0f, 0.0f), false);
+				Triangle *triangle = arena.create<Triangle>(this, vertexIndices, textureIndices, materialId, texture, normalTexture, SHADINGMODE_FLAT,
+					AffineTransform(), false, Vec3f(0.0f, 0.0f, 0.0f), false);
 				triangles.push_back(triangle);
 			}
 			stream.clear();
@@ -1196,7 +1209,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		}
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1214,7 +1227,13 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		LightMesh* lightMesh = new LightMesh(this, materialId, texture, normalTexture, triangles, transformationMat, transform, motionVec, motionBlur, radiance);
+		// A light mesh without faces cannot emit, and its triangles could not be sampled.
+		if (triangles.empty() == true)
+		{
+			throw std::runtime_error("Error: LightMesh has no faces.");
+		}
+
+		LightMesh* lightMesh = arena.create<LightMesh>(arena, this, materialId, texture, normalTexture, triangles, transformationMat, transform, motionVec, motionBlur, radiance);
 		lights.push_back(lightMesh);
 		objects.push_back(lightMesh);
 		element = element->NextSiblingElement("LightMesh");
@@ -1273,7 +1292,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		int textureIndices[3] = { v0, v1, v2 };
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1291,8 +1310,10 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		objects.push_back(new Triangle(this, vertexIndices, textureIndices, materialId, texture, normalTexture, SHADINGMODE_FLAT,
-			transformationMat, transform, motionVec, motionBlur));
+		Triangle* triangle = arena.create<Triangle>(this, vertexIndices, textureIndices, materialId, texture, normalTexture, SHADINGMODE_FLAT,
+			transformationMat, transform, motionVec, motionBlur);
+		parseMotionKeyframes(element, stream, triangle);
+		objects.push_back(triangle);
 		element = element->NextSiblingElement("Triangle");
 	}
 
@@ -1352,7 +1373,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		stream >> radius;
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1370,7 +1391,8 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		Sphere *sphere = new Sphere(this, centerVertexId, radius, materialId, texture, normalTexture, transformationMat, transform, motionVec, motionBlur);
+		Sphere *sphere = arena.create<Sphere>(this, centerVertexId, radius, materialId, texture, normalTexture, transformationMat, transform, motionVec, motionBlur);
+		parseMotionKeyframes(element, stream, sphere);
 		objects.push_back(sphere);
 		element = element->NextSiblingElement("Sphere");
 	}
@@ -1406,7 +1428,7 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 		stream >> radius;
 
 		bool transform = false;
-		Matrix4f transformationMat = Matrix4f(1.0f);
+		AffineTransform transformationMat = AffineTransform();
 		child = element->FirstChildElement("Transformations");
 		if (child)
 		{
@@ -1424,24 +1446,31 @@ void Scene::loadSceneFromXml(const std::string& filepath)
 			stream >> motionVec.x >> motionVec.y >> motionVec.z;
 		}
 
-		LightSphere* lightSphere = new LightSphere(this, centerVertexId, radius, materialId, texture, normalTexture, transformationMat, transform, motionVec, motionBlur, radiance);
+		LightSphere* lightSphere = arena.create<LightSphere>(this, centerVertexId, radius, materialId, texture, normalTexture, transformationMat, transform, motionVec, motionBlur, radiance);
 		lights.push_back(lightSphere);
 		objects.push_back(lightSphere);
 		element = element->NextSiblingElement("LightSphere");
 	}
 
-	// Normalize vertex normals
-	for (int i = 0; i < vertexData.size(); i++)
+	// Normalize and encode vertex normals, the sums are not needed after loading.
+	vertexNormals.resize(vertexNormalSums.size());
+	for (size_t i = 0; i < vertexNormalSums.size(); i++)
 	{
-		vertexData[i].vertexNormal = vertexData[i].vertexNormal / vertexData[i].numberOfAdjacentTriangles;
-		vertexData[i].vertexNormal = vertexData[i].vertexNormal.unitVector();
+		vertexNormals[i] = OctahedralNormal(vertexNormalSums[i].unitVector());
 	}
+	std::vector<Vec3f>().swap(vertexNormalSums);
+
+	// Command line overrides of the cameras.
+	applyRenderOptions();
 
 	std::cout << "Scene file is parsed successfully" << std::endl;
 
 	// Build bounding box hierarchy
-	bvh = new BVH(objects, 0, objects.size(), 0);
-	std::cout << "BVH is built successfully" << std::endl;
+	bvh = arena.create<BVH>(arena, objects, 0, objects.size(), 0);
+	std::cout << "BVH is built successfully, scene geometry uses " << arena.getAllocatedBytes() / 1024 << " KB" << std::endl;
+
+	// Light hierarchy is used by the cameras that sample one light per shading point.
+	lightBVH = new LightBVH(lights);
 }
 
 void Scene::parsePlyFile(const std::string& filepath, const std::string& plyFile, std::vector<Object*>& triangles,
@@ -1451,84 +1480,82 @@ void Scene::parsePlyFile(const std::string& filepath, const std::string& plyFile
 	std::string plyDir(filepath.substr(0, pos + 1));
 	std::string plyPath = plyDir + plyFile;
 
-	happly::PLYData plyData(plyPath);
-
-	std::vector<std::array<double, 3>> vertexPositions = plyData.getVertexPositions();
-	std::vector<std::vector<int>> faceIndices = plyData.getFaceIndices<int>();
-	std::vector<std::array<double, 2>> uvTexture = plyData.getTextureUv();
+	PlyLoader plyLoader(plyPath);
 
-	int numberOfExistingVertices = vertexData.size();
-	for (int i = 0; i < vertexPositions.size(); i++)
-	{
-		Vec3f vertex = Vec3f(vertexPositions[i][0], vertexPositions[i][1], vertexPositions[i][2]);
-		vertexData.push_back(vertex);
-	}
+	// Vertices are decoded straight into the scene buffers, which grow once by the size of the file.
+	int numberOfExistingVertices = vertexPositions.size();
+	vertexPositions.resize(numberOfExistingVertices + plyLoader.numberOfVertices);
+	vertexNormalSums.resize(vertexPositions.size());
 
 	int numberOfExistingTex = textureCoordData.size();
-	for (int i = 0; i < uvTexture.size(); i++)
+	if (plyLoader.hasTextureCoordinates == true)
 	{
-		Vec2f uv = Vec2f(uvTexture[i][0], uvTexture[i][1]);
-		textureCoordData.push_back(uv);
+		textureCoordData.resize(numberOfExistingTex + plyLoader.numberOfVertices);
 	}
 
+	plyLoader.readVertices(vertexPositions.data() + numberOfExistingVertices, textureCoordData.data() + numberOfExistingTex);
+
 	vertexOffset += numberOfExistingVertices;
 	textureOffset += numberOfExistingTex;
-	for (int i = 0; i < faceIndices.size(); i++)
+	triangles.reserve(triangles.size() + plyLoader.numberOfFaces);
+	for (int i = 0; i < plyLoader.numberOfFaces; i++)
 	{
-		if (faceIndices[i].size() == 3)
+		int faceIndices[4];
+		int numberOfIndices = plyLoader.readFace(faceIndices, 4);
+		if (numberOfIndices == 3)
 		{
 			// TRIANGLE FACES
 			// Calculate indices according to offset
-			int v0 = faceIndices[i][0];
-			int v1 = faceIndices[i][1];
-			int v2 = faceIndices[i][2];
+			int v0 = faceIndices[0];
+			int v1 = faceIndices[1];
+			int v2 = faceIndices[2];
 			int vertexIndices[3] = { vertexOffset + v0, vertexOffset + v1, vertexOffset + v2 };
 			int textureIndices[3] = { textureOffset + v0, textureOffset + v1, textureOffset + v2 };
 
-			Triangle *triangle = new Triangle(this, vertexIndices, textureIndices, materialId, texture, normalTexture, shadingMode,
-				Matrix4f(1.0f), false, Vec3f(0.0f, 0.0f, 0.0f), false);
+			Triangle *triangle = arena.create<Triangle>(this, vertexIndices, textureIndices, materialId, texture, normalTexture, shadingMode,
+				AffineTransform(), false, Vec3f(0.0f, 0.0f, 0.0f), false);
 			triangles.push_back(triangle);
 
 			if (shadingMode == SHADINGMODE_SMOOTH)
 			{
-				vertexData[vertexIndices[0]].addToVertexNormal(triangle->normal);
-				vertexData[vertexIndices[1]].addToVertexNormal(triangle->normal);
-				vertexData[vertexIndices[2]].addToVertexNormal(triangle->normal);
+				vertexNormalSums[vertexIndices[0]] += triangle->normal;
+				vertexNormalSums[vertexIndices[1]] += triangle->normal;
+				vertexNormalSums[vertexIndices[2]] += triangle->normal;
 			}
 		}
-		else if (faceIndices[i].size() == 4)
+		else if (numberOfIndices == 4)
 		{
 			// QUAD FACES
 			// Calculate indices according to offset
-			int v0 = faceIndices[i][0];
-			int v1 = faceIndices[i][1];
-			int v2 = faceIndices[i][2];
-			int v3 = faceIndices[i][3];
+			int v0 = faceIndices[0];
+			int v1 = faceIndices[1];
+			int v2 = faceIndices[2];
+			int v3 = faceIndices[3];
 			int vertexIndices1[3] = { vertexOffset + v0, vertexOffset + v1, vertexOffset + v2 };
 			int vertexIndices2[3] = { vertexOffset + v0, vertexOffset + v2, vertexOffset + v3 };
 			int textureIndices1[3] = { textureOffset + v0, textureOffset + v1, textureOffset + v2 };
 			int textureIndices2[3] = { textureOffset + v0, textureOffset + v2, textureOffset + v3 };
 
-			Triangle *triangle1 = new Triangle(this, vertexIndices1, textureIndices1, materialId, texture, normalTexture, shadingMode, Matrix4f(1.0f), false, Vec3f(0.0f, 0.0f, 0.0f), false);
-			Triangle *triangle2 = new Triangle(this, vertexIndices2, textureIndices2, materialId, texture, normalTexture, shadingMode, Matrix4f(1.0f), false, Vec3f(0.0f, 0.0f, 0.0f), false);
+			Triangle *triangle1 = arena.create<Triangle>(this, vertexIndices1, textureIndices1, materialId, texture, normalTexture, shadingMode, AffineTransform(), false, Vec3f(0.0f, 0.0f, 0.0f), false);
+			Triangle *triangle2 = arena.create<Triangle>(this, vertexIndices2, textureIndices2, materialId, texture, normalTexture, shadingMode, AffineTransform(), false, Vec3f(0.0f, 0.0f, 0.0f), false);
 			triangles.push_back(triangle1);
 			triangles.push_back(triangle2);
 
 			if (shadingMode == SHADINGMODE_SMOOTH)
 			{
-				vertexData[vertexIndices1[0]].addToVertexNormal(triangle1->normal);
-				vertexData[vertexIndices1[1]].addToVertexNormal(triangle1->normal);
-				vertexData[vertexIndices1[2]].addToVertexNormal(triangle1->normal);
+				vertexNormalSums[vertexIndices1[0]] += triangle1->normal;
+				vertexNormalSums[vertexIndices1[1]] += triangle1->normal;
+				vertexNormalSums[vertexIndices1[2]] += triangle1->normal;
 
-				vertexData[vertexIndices2[0]].addToVertexNormal(triangle2->normal);
-				vertexData[vertexIndices2[1]].addToVertexNormal(triangle2->normal);
-				vertexData[vertexIndices2[2]].addToVertexNormal(triangle2->normal);
+				vertexNormalSums[vertexIndices2[0]] += triangle2->normal;
+				vertexNormalSums[vertexIndices2[1]] += triangle2->normal;
+				vertexNormalSums[vertexIndices2[2]] += triangle2->normal;
 			}
 		}
 	}
 }
 
-void Scene::applyTransformations(tinyxml2::XMLElement* element, std::stringstream& stream, Matrix4f& matrix)
+void Scene::applyTransformations(tinyxml2::XMLElement* element, std::stringstream& stream, AffineTransform& transformation)
 {
 	char type;
 	int id;
@@ -1542,16 +1569,17 @@ void Scene::applyTransformations(tinyxml2::XMLElement* element, std::stringstrea
 		switch (type)
 		{
 		case 't':
-			matrix = translations[id].getTransformationMatrix() * matrix;
+			transformation = AffineTransform(translations[id].getTransformationMatrix(), translations[id].getInverseMatrix()) * transformation;
 			break;
 		case 's':
-			matrix = scalings[id].getTransformationMatrix() * matrix;
+			transformation = AffineTransform(scalings[id].getTransformationMatrix(), scalings[id].getInverseMatrix()) * transformation;
 			break;
 		case 'r':
-			matrix = rotations[id].getTransformationMatrix() * matrix;
+			transformation = AffineTransform(rotations[id].getTransformationMatrix(), rotations[id].getInverseMatrix()) * transformation;
 			break;
 		case 'c':
-			matrix = composites[id].getTransformationMatrix() * matrix;
+			// Composite matrices have no closed-form inverse, AffineTransform inverts them.
+			transformation = AffineTransform(composites[id].getTransformationMatrix()) * transformation;
 			break;
 		default:
 			break;
@@ -1561,6 +1589,61 @@ void Scene::applyTransformations(tinyxml2::XMLElement* element, std::stringstrea
 	stream.clear();
 }
 
+void Scene::parseMotionKeyframes(tinyxml2::XMLElement* element, std::stringstream& stream, Object* object)
+{
+	// Keyframes are given as translation, rotation (angle in degrees and axis) and scaling at a time in [0, 1].
+	auto child = element->FirstChildElement("MotionKeyframes");
+	if (child == NULL)
+	{
+		return;
+	}
+
+	std::vector<MotionKeyframe> keyframes;
+	auto keyframeElement = child->FirstChildElement("Keyframe");
+	while (keyframeElement)
+	{
+		MotionKeyframe keyframe;
+		keyframe.time = keyframeElement->FloatAttribute("time", 0.0f);
+
+		auto transformElement = keyframeElement->FirstChildElement("Translation");
+		if (transformElement)
+		{
+			stream << transformElement->GetText() << std::endl;
+			stream >> keyframe.translation.x >> keyframe.translation.y >> keyframe.translation.z;
+		}
+
+		transformElement = keyframeElement->FirstChildElement("Rotation");
+		if (transformElement)
+		{
+			float angle;
+			Vec3f axis;
+			stream << transformElement->GetText() << std::endl;
+			stream >> angle >> axis.x >> axis.y >> axis.z;
+			if (axis.length() == 0.0f)
+			{
+				throw std::runtime_error("Error: Rotation axis of a motion keyframe cannot be zero.");
+			}
+			keyframe.rotation = Quaternion::fromAxisAngle((angle * PI) / 180.0f, axis);	// Convert degree to radians.
+		}
+
+		transformElement = keyframeElement->FirstChildElement("Scaling");
+		if (transformElement)
+		{
+			stream << transformElement->GetText() << std::endl;
+			stream >> keyframe.scaling.x >> keyframe.scaling.y >> keyframe.scaling.z;
+		}
+
+		keyframes.push_back(keyframe);
+		keyframeElement = keyframeElement->NextSiblingElement("Keyframe");
+	}
+	stream.clear();
+
+	if (keyframes.empty() == false)
+	{
+		object->setKeyframedMotion(arena.create<KeyframedMotion>(keyframes));
+	}
+}
+
 void Scene::getRendererParams(tinyxml2::XMLElement* element, std::stringstream& stream, Camera& camera)
 {
 	std::string param;
@@ -1583,6 +1666,26 @@ void Scene::getRendererParams(tinyxml2::XMLElement* element, std::stringstream&
 			{
 				camera.importanceSampling = true;
 			}
+			else if (param == "MultipleImportanceSampling")
+			{
+				// Light samples come from next event estimation.
+				camera.multipleImportanceSampling = true;
+				camera.nextEventEstimation = true;
+			}
+			else if (param == "Wavefront")
+			{
+				camera.wavefront = true;
+			}
+			else if (param == "RaySorting")
+			{
+				// Rays are sorted in batches, so sorting implies wavefront path tracing.
+				camera.raySorting = true;
+				camera.wavefront = true;
+			}
+			else if (param == "LightTree")
+			{
+				camera.lightTree = true;
+			}
 		}
 	}
 
@@ -0,0 +1,263 @@
+#include "Scene.h"
+#include <algorithm>
+
+static unsigned int expandBits(unsigned int v)
+{
+	// Insert two zero bits after each of the lower 10 bits.
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+
+static unsigned int getMortonCode(const Vec3f& point, const BoundingBox& bounds)
+{
+	// 10 bits per axis, relative to the scene bounds.
+	unsigned int code = 0;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = bounds.maxCorner[axis] - bounds.minCorner[axis];
+		float x = extent > 0.0f ? (point[axis] - bounds.minCorner[axis]) / extent : 0.0f;
+		unsigned int cell = (unsigned int)std::min(std::max(x * 1024.0f, 0.0f), 1023.0f);
+		code |= expandBits(cell) << (2 - axis);
+	}
+
+	return code;
+}
+
+void Scene::renderTileWavefront(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, std::vector<Vec3f>& pixelColors)
+{
+	// Wavefront path tracing: all samples of the tile are advanced one bounce at a time.
+	// Buffers are kept per thread, so their memory is reused by the following tiles.
+	static thread_local PathBuffer paths;
+	static thread_local ShadowRayBuffer shadowRays;
+
+	paths.clear();
+	generatePaths(camera, minX, maxX, minY, maxY, pass, paths);
+
+	for (int depth = maxRecursionDepth; paths.size() > 0; depth--)
+	{
+		// Camera rays are already coherent, only the secondary rays are sorted.
+		if (camera.raySorting == true && depth < maxRecursionDepth)
+		{
+			sortPaths(paths);
+		}
+
+		extendPaths(paths, depth);
+
+		shadowRays.clear();
+		shadePaths(camera, depth, paths, shadowRays, pixelColors);
+		traceShadowRays(shadowRays, pixelColors);
+
+		paths.compact();
+	}
+}
+
+void Scene::generatePaths(const Camera& camera, int minX, int maxX, int minY, int maxY, int pass, PathBuffer& paths)
+{
+	int width = camera.imageWidth;
+
+	for (int i = minY; i < maxY; i++)
+	{
+		for (int j = minX; j < maxX; j++)
+		{
+			if (camera.numberOfSamples == 1)
+			{
+				float time = distribution(randGenerator);
+				paths.addPath(generateRay(camera, j, i, time), i * width + j);
+				continue;
+			}
+
+			// Same jittered samples as the depth-first path tracer, only the row of the sampling grid given by pass.
+			int numberOfMiniPixels = sqrt(camera.numberOfSamples);
+			for (int b = 0; b < numberOfMiniPixels; b++)
+			{
+				paths.addPath(sampleRay(camera, j, i, pass, b), i * width + j);
+			}
+		}
+	}
+}
+
+void Scene::sortPaths(PathBuffer& paths)
+{
+	// Group rays with the same direction octant and nearby origins, so that consecutive rays visit the same BVH nodes.
+	// Key is the octant in the upper 3 bits and the Morton code of the origin in the lower 29 bits.
+	const BoundingBox& bounds = bvh->getBoundingBox();
+
+	std::vector<std::pair<unsigned int, int>>& keys = paths.sortKeys;
+	keys.resize(paths.size());
+	for (int k = 0; k < paths.size(); k++)
+	{
+		const Vec3f& direction = paths.directions[k];
+		unsigned int octant = (direction.x < 0.0f) | ((direction.y < 0.0f) << 1) | ((direction.z < 0.0f) << 2);
+		unsigned int morton = getMortonCode(paths.origins[k], bounds);
+
+		keys[k] = std::make_pair((octant << 29) | (morton >> 1), k);
+	}
+
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<int>& order = paths.sortOrder;
+	order.resize(paths.size());
+	for (int k = 0; k < paths.size(); k++)
+	{
+		order[k] = keys[k].second;
+	}
+	paths.reorder(order);
+}
+
+void Scene::extendPaths(PathBuffer& paths, int depth)
+{
+	// Find the closest hit of every path.
+	StatisticsCounter counter = depth == maxRecursionDepth ? STATISTICS_CAMERARAYS : STATISTICS_SECONDARYRAYS;
+
+	for (int k = 0; k < paths.size(); k++)
+	{
+		Ray ray = paths.getRay(k);
+		paths.hitFound[k] = findClosestHit(ray, paths.hits[k]);
+		Statistics::increment(counter);
+	}
+}
+
+void Scene::shadePaths(const Camera& camera, int depth, PathBuffer& paths, ShadowRayBuffer& shadowRays, std::vector<Vec3f>& pixelColors)
+{
+	// Add the emitted and the ambient light, queue the shadow rays and sample the next ray of every path.
+	for (int k = 0; k < paths.size(); k++)
+	{
+		Ray ray = paths.getRay(k);
+		const Hit& hitResult = paths.hits[k];
+		Vec3f throughput = paths.throughputs[k];
+		int pixelIndex = paths.pixelIndices[k];
+		paths.alive[k] = false;
+
+		if (paths.hitFound[k] == false)
+		{
+			// No hit happened
+			if (maxRecursionDepth == depth)
+			{
+				// Primary ray, pixel's color is background color or background texture.
+				int i = pixelIndex % camera.imageWidth;
+				int j = pixelIndex / camera.imageWidth;
+				pixelColors[pixelIndex] += throughput * getBackgroundColor(i, j, ray);
+			}
+			continue;
+		}
+
+		const Material& material = camera.materials[hitResult.materialId];
+		Texture *texture = hitResult.texture;
+
+		if (hitResult.isLight == true)
+		{
+			// With next event estimation, lights hit by indirect rays are already sampled at the previous vertex.
+			// With multiple importance sampling, both samples are kept and weighted by their pdfs.
+			if (camera.nextEventEstimation == false || ray.indirect == false)
+			{
+				pixelColors[pixelIndex] += throughput * hitResult.radiance;
+			}
+			else if (camera.multipleImportanceSampling == true)
+			{
+				pixelColors[pixelIndex] += throughput * hitResult.radiance * getLightHitWeight(ray, hitResult, paths.lobePdfs[k], paths.lobeNormals[k], camera);
+			}
+			continue;
+		}
+
+		if (texture && texture->getDecalMode() == DECALMODE_REPLACEALL)
+		{
+			// If mode is replace_all, disable all shading and directly paste the texture color.
+			pixelColors[pixelIndex] += throughput * texture->getTextureColor(hitResult.uvTexture, hitResult.intersectionPoint);
+			continue;
+		}
+
+		// Do not add shading if ray is inside an object.
+		if (ray.isInsideObject == false)
+		{
+			pixelColors[pixelIndex] += throughput * (material.ambient * ambientLight);
+
+			if (camera.nextEventEstimation == true)
+			{
+				addShadowRays(ray, hitResult, material, texture, camera, depth, throughput, pixelIndex, shadowRays);
+			}
+		}
+
+		Ray nextRay = Ray();
+		Vec3f weight = Vec3f();
+		float lobePdf = 0.0f;
+		if (samplePathLobe(ray, hitResult, material, texture, camera, depth, nextRay, weight, lobePdf) == false)
+		{
+			continue;
+		}
+		throughput = throughput * weight;
+
+		if (camera.russianRoulette == true && depth < maxRecursionDepth)
+		{
+			// Terminate paths that carry little energy, survivors are weighted up to keep the estimate unbiased.
+			float survival = std::min(0.95f, throughput.getMax());
+			if (distribution(randGenerator) >= survival)
+			{
+				continue;
+			}
+			throughput = throughput / survival;
+		}
+
+		paths.setRay(k, nextRay);
+		paths.throughputs[k] = throughput;
+		paths.lobePdfs[k] = lobePdf;
+		paths.lobeNormals[k] = hitResult.normal;
+		paths.alive[k] = true;
+	}
+}
+
+void Scene::addShadowRays(const Ray& ray, const Hit& hitResult, const Material& material, const Texture* texture, const Camera& camera, int depth,
+	const Vec3f& throughput, int pixelIndex, ShadowRayBuffer& shadowRays)
+{
+	// Next event estimation, the shading of each light is computed now and added if its shadow ray is not occluded.
+	int numberOfLightSamples = getNumberOfLightSamples(camera);
+	for (int i = 0; i < numberOfLightSamples; i++)
+	{
+		float lightPmf;
+		Light *currentLight = selectLight(camera, hitResult, i, lightPmf);
+		if (currentLight == NULL)
+		{
+			continue;
+		}
+
+		LightSample lightSample = sampleLight(currentLight, hitResult);
+		if (lightSample.pdf <= 0.0f)
+		{
+			continue;
+		}
+
+		Vec3f wi = lightSample.wi;
+		Vec3f irradiance = lightSample.radiance / (lightSample.pdf * lightPmf);
+
+		float lightWeight = getLightSampleWeight(lightSample, lightPmf, ray, hitResult, material, camera, depth);
+		Vec3f contribution = throughput * surfaceShading(irradiance, wi, ray, hitResult, material, texture) * lightWeight;
+		if (contribution.getMax() <= 0.0f)
+		{
+			continue;
+		}
+
+		Ray shadowRay = Ray();
+		shadowRay.origin = hitResult.intersectionPoint + shadowRayEpsilon * hitResult.normal;
+		shadowRay.direction = wi;
+		shadowRay.time = ray.time;
+
+		shadowRays.addRay(shadowRay, lightSample.distance - testEpsilon, currentLight, contribution, pixelIndex);
+	}
+}
+
+void Scene::traceShadowRays(const ShadowRayBuffer& shadowRays, std::vector<Vec3f>& pixelColors)
+{
+	for (int k = 0; k < shadowRays.size(); k++)
+	{
+		Ray shadowRay = shadowRays.getRay(k);
+		bool occluded = bvh->occlusion(shadowRay, shadowRays.maxDistances[k], shadowRays.lights[k]);
+		Statistics::increment(STATISTICS_SHADOWRAYS);
+
+		if (occluded == false)
+		{
+			pixelColors[shadowRays.pixelIndices[k]] += shadowRays.contributions[k];
+		}
+	}
+}
@@ -2,10 +2,11 @@
 #include "Scene.h"
 
 Sphere::Sphere(const Scene* scene_, const int center_, float radius_, int material_, Texture* texture_, Texture* normalTexture_,
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_)
-	: Object(scene_, material_, texture_, normalTexture_, matrix_, transform_, motionVector_, motion_), centerVertexId(center_), radius(radius_)
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_)
+	: Object(scene_, material_, texture_, normalTexture_, transformation_, transform_, motionVector_, motion_), centerVertexId(center_), radius(radius_), radiusSquared(radius_ * radius_)
 {
-	center = scene->vertexData[centerVertexId].position;
+	type = OBJECTTYPE_SPHERE;
+	center = scene->vertexPositions[centerVertexId];
 	Vec3f r = Vec3f(radius, radius, radius);
 	Vec3f minCorner = center - r;
 	Vec3f maxCorner = center + r;
@@ -14,7 +15,7 @@ Sphere::Sphere(const Scene* scene_, const int center_, float radius_, int materi
 	if (transform == true)
 	{
 		// Transform bounding box to world coords.
-		boundingBox.applyTransformation(transformationMatrix);
+		boundingBox.applyTransformation(transformation);
 	}
 
 	if (motionBlur == true)
@@ -26,75 +27,93 @@ Sphere::Sphere(const Scene* scene_, const int center_, float radius_, int materi
 	}
 }
 
-bool Sphere::intersection(const Ray& ray, Hit& hit)
+bool Sphere::intersection(const Ray& ray, RayHit& hit)
 {
 	bool result = false;
 
 	Ray transformedRay = transformRay(ray);
 
-	float a = transformedRay.direction.dotProduct(transformedRay.direction);
-	float b = 2 * transformedRay.direction.dotProduct(transformedRay.origin - center);
-	float c = (transformedRay.origin - center).dotProduct(transformedRay.origin - center) - radius * radius;
+	// a t^2 - 2 b t + c = 0 with the halved b.
+	const Vec3f& d = transformedRay.direction;
+	Vec3f f = transformedRay.origin - center;
+	float a = d.dotProduct(d);
+	float b = -f.dotProduct(d);
 
-	float discriminant = b*b - 4*a*c;
+	// b^2 - ac evaluated as a (r^2 - |l|^2), where l is the closest point of the ray's line to the center.
+	// It does not cancel catastrophically when the sphere is small compared to its distance.
+	Vec3f l = f + (b / a) * d;
+	float discriminant = a * (radiusSquared - l.dotProduct(l));
 
 	if (discriminant < 0.0f)
 	{
 		// No intersection
 		return result;
 	}
-	else
-	{
-		// Intersection at 1 or 2 points
-		float t1 = (-1 * b + sqrt(discriminant)) / (2 * a);
-		float t2 = (-1 * b - sqrt(discriminant)) / (2 * a);
-		float t = std::min(t1, t2);
-
-		// If ray's origin is on the surface of the sphere, t1 = 0.
-		// If ray's origin is inside the sphere, t2 < 0.
-		if (t1 < 0.0f)
-		{
-			t = t2;
-		}
-		else if (t2 < 0.0f)
-		{
-			t = t1;
-		}
-
-		Vec3f intersectionPoint = transformedRay.pointAtParam(t);
-		Vec3f surfaceNormal = (intersectionPoint - center).unitVector();
-		Vec3f translatedIntersectionPoint = intersectionPoint - center;
 
-		hit.t = t;
-		hit.materialId = materialId;
-		hit.intersectionPoint = intersectionPoint;
-		hit.texture = texture;
-		hit.uvTexture = getTextureCoords(translatedIntersectionPoint, texture);
-		hit.normal = surfaceNormal;
-
-		if (normalTexture && normalTexture->isNormalMap)
-		{
-			// If normal mapping is used, replace the geometric normals with the normals computed from the texture image.
-			Vec2f uvNormalTexture = getTextureCoords(translatedIntersectionPoint, normalTexture);
-			Matrix3f tbnMatrix = computeTbnMatrix(translatedIntersectionPoint, surfaceNormal);
-			hit.normal = normalTexture->getNormalMapNormal(uvNormalTexture, tbnMatrix);
-		}
-		else if (normalTexture && normalTexture->isBumpMap)
-		{
-			// If bump mapping is used, replace the geometric normals with the bumped normals.
-			Vec2f uvNormalTexture = getTextureCoords(translatedIntersectionPoint, normalTexture);
-			Matrix3f tbnMatrix = computeTbnMatrix(translatedIntersectionPoint, surfaceNormal);
-			hit.normal = normalTexture->getBumpNormal(translatedIntersectionPoint, surfaceNormal, tbnMatrix, uvNormalTexture);
-		}
-
-		hit = transformHit(hit, transformedRay.time);
+	// One square root, the second root follows from t1 * t2 = c / a without subtracting close values.
+	float c = f.dotProduct(f) - radiusSquared;
+	float q = b + copysign(sqrt(discriminant), b);
+	float t1 = c / q;
+	float t2 = q / a;
+	float tNear = std::min(t1, t2);
+	float tFar = std::max(t1, t2);
+
+	// If ray's origin is inside the sphere, the near intersection is behind it.
+	float t = (tNear > 0.0f) ? tNear : tFar;
 
+	if (t > 0.0f && t < hit.t)
+	{
+		hit.t = t;
+		hit.primitive = this;
+		hit.instance = NULL;
 		result = true;
 	}
 
 	return result;
 }
 
+bool Sphere::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	RayHit hit = RayHit();
+	hit.t = tMax;
+
+	return Sphere::intersection(ray, hit);
+}
+
+Hit Sphere::getHit(const Ray& ray, const RayHit& rayHit) const
+{
+	Ray transformedRay = transformRay(ray);
+
+	Vec3f intersectionPoint = transformedRay.pointAtParam(rayHit.t);
+	Vec3f surfaceNormal = (intersectionPoint - center).unitVector();
+	Vec3f translatedIntersectionPoint = intersectionPoint - center;
+
+	Hit hit = Hit();
+	hit.t = rayHit.t;
+	hit.materialId = materialId;
+	hit.intersectionPoint = intersectionPoint;
+	hit.texture = texture;
+	hit.uvTexture = getTextureCoords(translatedIntersectionPoint, texture);
+	hit.normal = surfaceNormal;
+
+	if (normalTexture && normalTexture->isNormalMap)
+	{
+		// If normal mapping is used, replace the geometric normals with the normals computed from the texture image.
+		Vec2f uvNormalTexture = getTextureCoords(translatedIntersectionPoint, normalTexture);
+		Matrix3f tbnMatrix = computeTbnMatrix(translatedIntersectionPoint, surfaceNormal);
+		hit.normal = normalTexture->getNormalMapNormal(uvNormalTexture, tbnMatrix);
+	}
+	else if (normalTexture && normalTexture->isBumpMap)
+	{
+		// If bump mapping is used, replace the geometric normals with the bumped normals.
+		Vec2f uvNormalTexture = getTextureCoords(translatedIntersectionPoint, normalTexture);
+		Matrix3f tbnMatrix = computeTbnMatrix(translatedIntersectionPoint, surfaceNormal);
+		hit.normal = normalTexture->getBumpNormal(translatedIntersectionPoint, surfaceNormal, tbnMatrix, uvNormalTexture);
+	}
+
+	return transformHit(hit, transformedRay.time);
+}
+
 Vec2f Sphere::getTextureCoords(const Vec3f& point, Texture* tex) const
 {
 	Vec2f uv = Vec2f();
@@ -112,7 +131,7 @@ Vec2f Sphere::getTextureCoords(const Vec3f& point, Texture* tex) const
 	return uv;
 }
 
-Matrix3f Sphere::computeTbnMatrix(const Vec3f& point, const Vec3f& normal)
+Matrix3f Sphere::computeTbnMatrix(const Vec3f& point, const Vec3f& normal) const
 {
 	Matrix3f tbn = Matrix3f();
 	if (!normalTexture)
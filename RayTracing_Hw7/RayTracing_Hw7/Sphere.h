@@ -11,14 +11,17 @@ public:
 	const int centerVertexId;
 	Vec3f center;
 	float radius;
+	float radiusSquared;
 
 	Sphere(const Scene* scene_, const int center_, float radius_, int material_, Texture* texture_, Texture* normalTexture_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_);
-	bool intersection(const Ray& ray, Hit& hit);
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_);
+	bool intersection(const Ray& ray, RayHit& hit);
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
 	Vec2f getTextureCoords(const Vec3f& point, Texture* tex) const;
 
 private:
-	Matrix3f computeTbnMatrix(const Vec3f& point, const Vec3f& normal);
+	Matrix3f computeTbnMatrix(const Vec3f& point, const Vec3f& normal) const;
 };
 
 #endif
\ No newline at end of file
@@ -1,56 +1,58 @@
 #include "Light.h"
 
-// Each thread works on separate l objects.
-thread_local Vec3f SphericalDirectionalLight::l;
-
 SphericalDirectionalLight::SphericalDirectionalLight(const std::string& imagePath_)
 {
 	environmentMap = new ImageTexture(imagePath_, "nearest", "replace_kd", 255.0f, 1.0f);
 
-	// Initialize uniform random distribution to sample points inside the spherical light later.
-	randGenerator.seed(std::chrono::system_clock::now().time_since_epoch().count());
-	distribution = std::uniform_real_distribution<float>(0.0f, 1.0f);
-}
-
-Vec3f SphericalDirectionalLight::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
-{
-	// Uniform Random Rejection Sampling
-	while (true)
+	// Texels are sampled proportional to their luminance. Rows near the poles cover a smaller solid angle, so they are weighted by sin(theta).
+	int width = environmentMap->width;
+	int height = environmentMap->height;
+	std::vector<float> values(width * height);
+	for (int j = 0; j < height; j++)
 	{
-		// Sample points in [0,1] range.
-		l.x = distribution(randGenerator);
-		l.y = distribution(randGenerator);
-		l.z = distribution(randGenerator);
-
-		// Bring them to [-1,1] range.
-		l.x = 2.0f * l.x - 1.0f;
-		l.y = 2.0f * l.y - 1.0f;
-		l.z = 2.0f * l.z - 1.0f;
-
-		if (l.length() <= 1.0f && (l.dotProduct(normal) > 0.0f))
+		float sinTheta = sin(PI * (j + 0.5f) / height);
+		for (int i = 0; i < width; i++)
 		{
-			l = l.unitVector();
-			break;
+			Vec3f rgb = environmentMap->fetch(i, j);
+			values[j * width + i] = (0.2126f * rgb.x + 0.7152f * rgb.y + 0.0722f * rgb.z) * sinTheta;
 		}
 	}
-	
-	return l;
+	environmentDistribution = new Distribution2D(values.data(), width, height);
 }
 
-float SphericalDirectionalLight::calculateDistance(const Vec3f& intersectionPoint)
+LightSample SphericalDirectionalLight::sample(const Vec3f&, const Vec3f& normal, const Vec2f& e) const
 {
-	float dist = std::numeric_limits<float>::max();
-	return dist;
-}
+	// Importance sampling of the environment map, (u,v) is chosen with the texel distribution.
+	float uvPdf;
+	Vec2f uv = environmentDistribution->sampleContinuous(e.x, e.y, uvPdf);
 
-Vec3f SphericalDirectionalLight::calculateIrradiance(const Vec3f& intersectionPoint)
-{
-	// l is already computed when calculateWi was called.
-	Vec3f L = getTextureColor(l);
-	return L * (2.0f * PI);
+	// Inverse of the mapping in getTextureColor.
+	float theta = uv.y * PI;
+	float phi = PI - uv.x * 2.0f * PI;
+	float sinTheta = sin(theta);
+
+	LightSample lightSample;
+	lightSample.wi = Vec3f(sinTheta * cos(phi), cos(theta), sinTheta * sin(phi));
+	lightSample.distance = std::numeric_limits<float>::max();
+
+	// Directions below the surface cannot light it, the specular term alone would not cancel them.
+	if (lightSample.wi.dotProduct(normal) <= 0.0f)
+	{
+		return lightSample;
+	}
+
+	lightSample.radiance = getTextureColor(lightSample.wi);
+
+	// Convert the pdf from (u,v) to solid angle, dw = 2 * PI^2 * sin(theta) du dv.
+	if (sinTheta > 0.0f)
+	{
+		lightSample.pdf = uvPdf / (2.0f * PI * PI * sinTheta);
+	}
+
+	return lightSample;
 }
 
-Vec3f SphericalDirectionalLight::getTextureColor(const Vec3f& lDir)
+Vec3f SphericalDirectionalLight::getTextureColor(const Vec3f& lDir) const
 {
 	float theta = acos(lDir.y);
 	float phi = atan2(lDir.z, lDir.x);
@@ -61,3 +63,8 @@ Vec3f SphericalDirectionalLight::getTextureColor(const Vec3f& lDir)
 	return color;
 }
 
+SphericalDirectionalLight::~SphericalDirectionalLight()
+{
+	delete environmentDistribution;
+	delete environmentMap;
+}
@@ -1,32 +1,24 @@
 #include "Light.h"
+#include "LightBVH.h"
 
-Vec3f SpotLight::calculateWi(const Vec3f& intersectionPoint, const Vec3f& normal)
+LightSample SpotLight::sample(const Vec3f& intersectionPoint, const Vec3f&, const Vec2f&) const
 {
-	Vec3f wi = (position - intersectionPoint).unitVector();
-	return wi;
-}
+	LightSample lightSample;
+	Vec3f l = position - intersectionPoint;
+	lightSample.distance = l.length();
+	lightSample.wi = l / lightSample.distance;
 
-float SpotLight::calculateDistance(const Vec3f& intersectionPoint)
-{
-	float dist = (position - intersectionPoint).length();
-	return dist;
-}
-
-Vec3f SpotLight::calculateIrradiance(const Vec3f& intersectionPoint)
-{
-	float falloff = calculateFalloff(intersectionPoint);
+	float falloff = calculateFalloff(lightSample.wi);
+	lightSample.radiance = falloff * (intensity / (lightSample.distance * lightSample.distance));
+	lightSample.pdf = 1.0f;
 
-	float lightDistance = calculateDistance(intersectionPoint);
-	Vec3f irradiance = falloff * (intensity / (lightDistance * lightDistance));
-
-	return irradiance;
+	return lightSample;
 }
 
-float SpotLight::calculateFalloff(const Vec3f& intersectionPoint)
+float SpotLight::calculateFalloff(const Vec3f& wi) const
 {
 	// Find angle between direction and -wi
-	Vec3f wi = calculateWi(intersectionPoint, Vec3f());
-	float cosTheta = direction.unitVector().dotProduct(-1 * wi);
+	float cosTheta = direction.dotProduct(-1 * wi);
 	float theta = acos(cosTheta);
 
 	if (theta < (beta / 2.0f))
@@ -48,4 +40,15 @@ float SpotLight::calculateFalloff(const Vec3f& intersectionPoint)
 	falloff = pow(falloff, 4);
 
 	return falloff;
+}
+
+bool SpotLight::getLightBounds(LightBounds& lightBounds) const
+{
+	// Full intensity inside the falloff angle, no light outside the coverage angle.
+	lightBounds.bounds = BoundingBox(position, position);
+	lightBounds.axis = direction;
+	lightBounds.cosThetaO = cos(beta / 2.0f);
+	lightBounds.cosThetaE = cos(std::max(0.0f, alpha / 2.0f - beta / 2.0f));
+	lightBounds.power = 2.0f * PI * (1.0f - cos(alpha / 2.0f)) * intensity.getAvg();
+	return true;
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "Statistics.h"
+#include <cstdlib>
+#include <new>
+
+bool Statistics::countAllocations = false;
+thread_local long long Statistics::localCounters[STATISTICS_COUNT] = {};
+std::atomic<long long> Statistics::totalCounters[STATISTICS_COUNT] = {};
+
+void Statistics::flush()
+{
+	for (int i = 0; i < STATISTICS_COUNT; i++)
+	{
+		totalCounters[i] += localCounters[i];
+		localCounters[i] = 0;
+	}
+}
+
+long long Statistics::getTotal(StatisticsCounter counter)
+{
+	return totalCounters[counter];
+}
+
+void Statistics::printStatistics(std::ostream& stream, double seconds)
+{
+	long long cameraRays = getTotal(STATISTICS_CAMERARAYS);
+	long long secondaryRays = getTotal(STATISTICS_SECONDARYRAYS);
+	long long shadowRays = getTotal(STATISTICS_SHADOWRAYS);
+	long long totalRays = cameraRays + secondaryRays + shadowRays;
+
+	stream << "Camera rays:    " << cameraRays << std::endl;
+	stream << "Secondary rays: " << secondaryRays << std::endl;
+	stream << "Shadow rays:    " << shadowRays << std::endl;
+	stream << "Total rays:     " << totalRays << std::endl;
+	// Counters are flushed after every tile, so allocations of loading and image writing are not included.
+	stream << "Allocations:    " << getTotal(STATISTICS_ALLOCATIONS) << " (tile tasks only)" << std::endl;
+	if (seconds > 0.0)
+	{
+		stream << "Mrays/sec:      " << totalRays / seconds / 1e6 << std::endl;
+	}
+}
+
+// Heap allocations are counted to find allocations in the render loop, they contend on the allocator across threads.
+void* operator new(std::size_t size)
+{
+	if (Statistics::countAllocations == true)
+	{
+		Statistics::increment(STATISTICS_ALLOCATIONS);
+	}
+
+	void* pointer = std::malloc(size > 0 ? size : 1);
+	if (pointer == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
\ No newline at end of file
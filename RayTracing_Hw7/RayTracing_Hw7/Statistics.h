@@ -0,0 +1,33 @@
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include <atomic>
+#include <iostream>
+
+enum StatisticsCounter
+{
+	STATISTICS_CAMERARAYS = 0,
+	STATISTICS_SECONDARYRAYS,
+	STATISTICS_SHADOWRAYS,
+	STATISTICS_ALLOCATIONS,		// calls of the global operator new in tile tasks, only counted if countAllocations is set
+	STATISTICS_COUNT
+};
+
+// Render counters for performance measurements.
+// Each thread increments its own counters, they are added to the shared totals with flush after every tile.
+class Statistics
+{
+public:
+	static bool countAllocations;	// set before the render threads start, counting is off by default
+
+	static void increment(StatisticsCounter counter) { localCounters[counter]++; }
+	static void flush();
+	static long long getTotal(StatisticsCounter counter);
+	static void printStatistics(std::ostream& stream, double seconds);
+
+private:
+	static thread_local long long localCounters[STATISTICS_COUNT];
+	static std::atomic<long long> totalCounters[STATISTICS_COUNT];
+};
+
+#endif
@@ -26,6 +26,7 @@ public:
 	virtual Vec3f getTextureColor(const Vec2f& uv, const Vec3f& p) const = 0;
 	virtual Vec3f getNormalMapNormal(const Vec2f& uv, const Matrix3f& tbn) const = 0;
 	virtual Vec3f getBumpNormal(const Vec3f& p, const Vec3f& normal, const Matrix3f& tbn, const Vec2f& uv) const = 0;
+	virtual ~Texture() {}
 
 protected:
 	DecalMode decalMode;
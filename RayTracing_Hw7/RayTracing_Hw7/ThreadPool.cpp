@@ -0,0 +1,81 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numberOfThreads_)
+	: activeTasks(0), stopping(false)
+{
+	if (numberOfThreads_ < 1)
+	{
+		numberOfThreads_ = 1;
+	}
+
+	for (int i = 0; i < numberOfThreads_; i++)
+	{
+		threads.push_back(std::thread(&ThreadPool::processTasks, this));
+	}
+}
+
+void ThreadPool::addTask(const std::function<void()>& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(task);
+	}
+	taskAdded.notify_one();
+}
+
+void ThreadPool::waitForTasks()
+{
+	// Tasks can add new tasks, so wait until the queue is empty and no task is running.
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksFinished.wait(lock, [this]() { return tasks.empty() && activeTasks == 0; });
+}
+
+int ThreadPool::getNumberOfThreads() const
+{
+	return threads.size();
+}
+
+void ThreadPool::processTasks()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			taskAdded.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty())
+			{
+				return;
+			}
+
+			task = tasks.front();
+			tasks.pop_front();
+			activeTasks++;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			activeTasks--;
+			if (tasks.empty() && activeTasks == 0)
+			{
+				tasksFinished.notify_all();
+			}
+		}
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAdded.notify_all();
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
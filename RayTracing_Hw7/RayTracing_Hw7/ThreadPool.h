@@ -0,0 +1,34 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads that process tasks from a shared queue.
+// Tasks may add new tasks to the pool while they are running.
+class ThreadPool
+{
+public:
+	ThreadPool(int numberOfThreads_);
+	void addTask(const std::function<void()>& task);
+	void waitForTasks();
+	int getNumberOfThreads() const;
+	~ThreadPool();
+
+private:
+	std::vector<std::thread> threads;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable taskAdded;
+	std::condition_variable tasksFinished;
+	int activeTasks;	// number of tasks being processed by the workers
+	bool stopping;
+
+	void processTasks();
+};
+
+#endif
@@ -32,6 +32,17 @@ Vec3f TorranceSparrowBRDF::getBRDFValue(const Hit& hit, const Material& material
 	return irradiance * brdfValue * cosTheta;
 }
 
+Vec3f TorranceSparrowBRDF::sampleSpecular(const Hit& hit, const Vec3f& wo, const Vec2f& e) const
+{
+	// Half vectors are sampled proportional to D * cosAlphaH, which is a cosine power lobe of exponent + 1.
+	return sampleHalfVectorLobe(hit, wo, exponent + 1.0f, e);
+}
+
+float TorranceSparrowBRDF::specularPdf(const Hit& hit, const Vec3f& wi, const Vec3f& wo) const
+{
+	return halfVectorLobePdf(hit, wi, wo, exponent + 1.0f);
+}
+
 float TorranceSparrowBRDF::blinnDistribution(float cosAlpha) const
 {
 	float result = ((exponent + 2.0f) / (2.0f * PI)) * pow(cosAlpha, exponent);
@@ -15,6 +15,12 @@ Translation::Translation(const Vec3f& translationVec_)
 	transformationMatrix[2][3] = translationVec.z;
 }
 
+Matrix4f Translation::getInverseMatrix() const
+{
+	// Translation by the opposite vector.
+	return Translation(Vec3f(-translationVec.x, -translationVec.y, -translationVec.z)).getTransformationMatrix();
+}
+
 Scaling::Scaling(const Vec3f& scalingVec_)
 	: scalingVec(scalingVec_)
 {
@@ -25,6 +31,12 @@ Scaling::Scaling(const Vec3f& scalingVec_)
 	transformationMatrix[3][3] = 1.0f;
 }
 
+Matrix4f Scaling::getInverseMatrix() const
+{
+	// Scaling by the reciprocal factors.
+	return Scaling(Vec3f(1.0f / scalingVec.x, 1.0f / scalingVec.y, 1.0f / scalingVec.z)).getTransformationMatrix();
+}
+
 Rotation::Rotation(float angleRad_, const Vec3f& axis_)
 	: angleRad(angleRad_), axis(axis_)
 {
@@ -49,6 +61,12 @@ Rotation::Rotation(float angleRad_, const Vec3f& axis_)
 	transformationMatrix[3][3] = 1.0f;
 }
 
+Matrix4f Rotation::getInverseMatrix() const
+{
+	// Rotation by the opposite angle around the same axis.
+	return Rotation(-angleRad, axis).getTransformationMatrix();
+}
+
 Composite::Composite(float elements_[])
 {
 	transformationMatrix = Matrix4f();
@@ -18,6 +18,7 @@ public:
 	Vec3f translationVec;
 
 	Translation(const Vec3f& translationVec_);
+	Matrix4f getInverseMatrix() const;
 };
 
 class Scaling : public Transformation
@@ -26,6 +27,7 @@ public:
 	Vec3f scalingVec;
 
 	Scaling(const Vec3f& scalingVec_);
+	Matrix4f getInverseMatrix() const;
 };
 
 class Rotation : public Transformation
@@ -35,6 +37,7 @@ public:
 	Vec3f axis;
 
 	Rotation(float angleRad_, const Vec3f& axis_);
+	Matrix4f getInverseMatrix() const;
 };
 
 class Composite : public Transformation
@@ -2,9 +2,10 @@
 #include "Scene.h"
 
 Triangle::Triangle(const Scene* scene_, int vertexIndices_[], int textureIndices_[], int material_, Texture* texture_, Texture* normalTexture_, ShadingMode shadingMode_,
-	const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_)
-	: Object(scene_, material_, texture_, normalTexture_, matrix_, transform_, motionVector_, motion_), shadingMode(shadingMode_)
+	const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_)
+	: Object(scene_, material_, texture_, normalTexture_, transformation_, transform_, motionVector_, motion_), shadingMode(shadingMode_)
 {
+	type = OBJECTTYPE_TRIANGLE;
 	v0 = vertexIndices_[0];
 	v1 = vertexIndices_[1];
 	v2 = vertexIndices_[2];
@@ -14,9 +15,9 @@ Triangle::Triangle(const Scene* scene_, int vertexIndices_[], int textureIndices
 	t2 = textureIndices_[2];
 
 	// Calculate surface normal
-	Vec3f a = scene->vertexData[v0].position;
-	Vec3f b = scene->vertexData[v1].position;
-	Vec3f c = scene->vertexData[v2].position;
+	Vec3f a = scene->vertexPositions[v0];
+	Vec3f b = scene->vertexPositions[v1];
+	Vec3f c = scene->vertexPositions[v2];
 
 	normal = (b - a).crossProduct(c - a).unitVector();
 
@@ -36,7 +37,7 @@ Triangle::Triangle(const Scene* scene_, int vertexIndices_[], int textureIndices
 	if (transform == true)
 	{
 		// Transform bounding box to world coords.
-		boundingBox.applyTransformation(transformationMatrix);
+		boundingBox.applyTransformation(transformation);
 	}
 
 	// Compute TBN matrix of the triangle.
@@ -50,7 +51,7 @@ float Triangle::determinant(const Vec3f &v0, const Vec3f &v1, const Vec3f &v2)
 		 + v0.z * (v1.x * v2.y - v1.y * v2.x);
 }
 
-bool Triangle::intersection(const Ray& ray, Hit& hit)
+bool Triangle::intersection(const Ray& ray, RayHit& hit)
 {
 	bool result = false;
 
@@ -58,9 +59,9 @@ bool Triangle::intersection(const Ray& ray, Hit& hit)
 
 	Vec3f o = transformedRay.origin;
 	Vec3f d = transformedRay.direction;
-	Vec3f a = scene->vertexData[v0].position;
-	Vec3f b = scene->vertexData[v1].position;
-	Vec3f c = scene->vertexData[v2].position;
+	Vec3f a = scene->vertexPositions[v0];
+	Vec3f b = scene->vertexPositions[v1];
+	Vec3f c = scene->vertexPositions[v2];
 
 	float detA = determinant(a - b, a - c, d);
 	if (detA == 0.0f)
@@ -68,8 +69,9 @@ bool Triangle::intersection(const Ray& ray, Hit& hit)
 		return result;
 	}
 
+	// Intersections behind the origin or beyond the closest hit so far are rejected before the barycentrics.
 	float t = (determinant(a - b, a - c, a - o)) / detA;
-	if (t < 0.0f - epsilon)
+	if (t <= 0.0f || t >= hit.t)
 	{
 		return result;
 	}
@@ -87,8 +89,24 @@ bool Triangle::intersection(const Ray& ray, Hit& hit)
 	}
 
 	hit.t = t;
+	hit.primitive = this;
+	hit.instance = NULL;
+	hit.barycentrics = Vec2f(beta, gamma);
+
+	result = true;
+	return result;
+}
+
+Hit Triangle::getHit(const Ray& ray, const RayHit& rayHit) const
+{
+	Ray transformedRay = transformRay(ray);
+	float beta = rayHit.barycentrics.x;
+	float gamma = rayHit.barycentrics.y;
+
+	Hit hit = Hit();
+	hit.t = rayHit.t;
 	hit.materialId = materialId;
-	hit.intersectionPoint = transformedRay.pointAtParam(t);
+	hit.intersectionPoint = transformedRay.pointAtParam(rayHit.t);
 	hit.texture = texture;
 	hit.uvTexture = getTextureCoords(beta, gamma, texture);
 
@@ -98,9 +116,9 @@ bool Triangle::intersection(const Ray& ray, Hit& hit)
 	}
 	else if (shadingMode == SHADINGMODE_SMOOTH)
 	{
-		hit.normal = (1 - beta - gamma) * scene->vertexData[v0].vertexNormal
-								 + beta * scene->vertexData[v1].vertexNormal
-								 + gamma * scene->vertexData[v2].vertexNormal;
+		hit.normal = (1 - beta - gamma) * scene->vertexNormals[v0].decode()
+								 + beta * scene->vertexNormals[v1].decode()
+								 + gamma * scene->vertexNormals[v2].decode();
 	}
 
 	if (normalTexture && normalTexture->isNormalMap)
@@ -117,10 +135,45 @@ bool Triangle::intersection(const Ray& ray, Hit& hit)
 	}
 
 	// For triangles belonging to a mesh, transform is set as false, so hit will be returned as it is.
-	hit = transformHit(hit, transformedRay.time);
+	return transformHit(hit, transformedRay.time);
+}
 
-	result = true;
-	return result;
+bool Triangle::occlusion(const Ray& ray, float tMax, const Light* ignoredLight)
+{
+	// Same test as intersection, but only t is needed for shadow rays.
+	Ray transformedRay = transformRay(ray);
+
+	Vec3f o = transformedRay.origin;
+	Vec3f d = transformedRay.direction;
+	Vec3f a = scene->vertexPositions[v0];
+	Vec3f b = scene->vertexPositions[v1];
+	Vec3f c = scene->vertexPositions[v2];
+
+	float detA = determinant(a - b, a - c, d);
+	if (detA == 0.0f)
+	{
+		return false;
+	}
+
+	float t = (determinant(a - b, a - c, a - o)) / detA;
+	if (t <= 0.0f || t >= tMax)
+	{
+		return false;
+	}
+
+	float gamma = (determinant(a - b, a - o, d)) / detA;
+	if (gamma < 0.0f - epsilon || gamma > 1.0f + epsilon)
+	{
+		return false;
+	}
+
+	float beta = (determinant(a - o, a - c, d)) / detA;
+	if (beta < 0.0f - epsilon || beta > (1.0f + epsilon - gamma))
+	{
+		return false;
+	}
+
+	return true;
 }
 
 Vec2f Triangle::getTextureCoords(float beta, float gamma, Texture* tex) const
@@ -152,9 +205,9 @@ Matrix3f Triangle::computeTbnMatrix()
 	Vec2f uv1 = scene->textureCoordData[t1];
 	Vec2f uv2 = scene->textureCoordData[t2];
 
-	Vec3f posv0 = scene->vertexData[v0].position;
-	Vec3f posv1 = scene->vertexData[v1].position;
-	Vec3f posv2 = scene->vertexData[v2].position;
+	Vec3f posv0 = scene->vertexPositions[v0];
+	Vec3f posv1 = scene->vertexPositions[v1];
+	Vec3f posv2 = scene->vertexPositions[v2];
 
 	Vec3f e1 = posv1 - posv0;
 	Vec3f e2 = posv2 - posv0;
@@ -181,16 +234,16 @@ Matrix3f Triangle::computeTbnMatrix()
 	return tbn;
 }
 
-float Triangle::getArea(const Matrix4f& matrix) const
+float Triangle::getArea(const AffineTransform& transformation) const
 {
 	// Apply the transformations and calculate the triangle's area.
-	Vec3f a = scene->vertexData[v0].position;
-	Vec3f b = scene->vertexData[v1].position;
-	Vec3f c = scene->vertexData[v2].position;
+	Vec3f a = scene->vertexPositions[v0];
+	Vec3f b = scene->vertexPositions[v1];
+	Vec3f c = scene->vertexPositions[v2];
 
-	Vec3f aNew = matrix.multiplyWithPoint(a);
-	Vec3f bNew = matrix.multiplyWithPoint(b);
-	Vec3f cNew = matrix.multiplyWithPoint(c);
+	Vec3f aNew = transformation.multiplyWithPoint(a);
+	Vec3f bNew = transformation.multiplyWithPoint(b);
+	Vec3f cNew = transformation.multiplyWithPoint(c);
 
 	float area = (bNew - aNew).crossProduct(cNew - aNew).length() / 2.0f;
 	return area;
@@ -11,19 +11,21 @@ enum ShadingMode
 	SHADINGMODE_SMOOTH
 };
 
-class Triangle : public Object
+class Triangle final : public Object
 {
 public:
-	int v0, v1, v2;	// indices to vertexData
+	int v0, v1, v2;	// indices to vertexPositions and vertexNormals
 	int t0, t1, t2;	// indices to textureCoordData
 	Vec3f normal;
 	ShadingMode shadingMode;
 
 	Triangle(const Scene* scene_, int vertexIndices_[], int textureIndices_[], int material_, Texture* texture_, Texture* normalTexture_, ShadingMode shadingMode_,
-		const Matrix4f& matrix_, bool transform_, const Vec3f& motionVector_, bool motion_);
-	bool intersection(const Ray& ray, Hit& hit);
+		const AffineTransform& transformation_, bool transform_, const Vec3f& motionVector_, bool motion_);
+	bool intersection(const Ray& ray, RayHit& hit);
+	Hit getHit(const Ray& ray, const RayHit& rayHit) const;
+	bool occlusion(const Ray& ray, float tMax, const Light* ignoredLight);
 	Vec2f getTextureCoords(float beta, float gamma, Texture* tex) const;
-	float getArea(const Matrix4f& matrix) const;
+	float getArea(const AffineTransform& transformation) const;
 
 private:
 	Matrix3f tbnMatrix;
@@ -4,6 +4,14 @@
 #include <chrono>
 #include <iostream>
 
+// Power heuristic (beta = 2) weight of the strategy with pdfA, when pdfB is the pdf of the other strategy.
+inline float powerHeuristic(float pdfA, float pdfB)
+{
+	float a = pdfA * pdfA;
+	float b = pdfB * pdfB;
+	return (a + b) > 0.0f ? a / (a + b) : 0.0f;
+}
+
 template <typename T>
 void printTimeDuration(const std::string& imageName, T start, T end)
 {
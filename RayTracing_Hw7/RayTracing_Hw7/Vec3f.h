@@ -41,9 +41,10 @@ public:
 	Vec3f crossProduct(const Vec3f& rhs) const;
 	float length() const;
 	float lengthSquared() const;
-	Vec3f unitVector();
+	Vec3f unitVector() const;
 	int getAbsMinElementIndex() const;
 	float getAvg() const;
+	float getMax() const;
 	Vec3f pow(float exp);
 
 	friend std::ostream& operator<<(std::ostream& os, const Vec3f& v);
@@ -178,7 +179,7 @@ inline float Vec3f::lengthSquared() const
 	return x*x + y*y + z*z;
 }
 
-inline Vec3f Vec3f::unitVector()
+inline Vec3f Vec3f::unitVector() const
 {
 	// Normalize the vector.
 	return (*this) / this->length();
@@ -205,6 +206,11 @@ inline float Vec3f::getAvg() const
 	return (x + y + z) / 3.0f;
 }
 
+inline float Vec3f::getMax() const
+{
+	return std::max(x, std::max(y, z));
+}
+
 inline Vec3f Vec3f::pow(float exp)
 {
 	Vec3f res = Vec3f();